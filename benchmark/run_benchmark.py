@@ -0,0 +1,80 @@
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOLVERS = ["cdcl", "dpll", "dp", "resolution", "local_search", "portfolio", "cube_and_conquer"]
+DEFAULT_SUITES = [os.path.join(ROOT, "cnf_files", "tests", "2sat_cnf"),
+                  os.path.join(ROOT, "cnf_files", "tests", "3sat_cnf")]
+
+def solver_source(solver):
+    return os.path.join(ROOT, "sat_solvers", solver, "sat_solver.cpp")
+
+def solver_binary(solver, build_dir):
+    return os.path.join(build_dir, solver + (".exe" if os.name == "nt" else ""))
+
+def build(solver, build_dir, compiler):
+    os.makedirs(build_dir, exist_ok=True)
+    command = [compiler, "-std=c++17", "-O2", "-pthread", "-o", solver_binary(solver, build_dir), solver_source(solver)]
+    print(" ".join(command))
+    return subprocess.call(command) == 0
+
+def run(solver, args, extra):
+    os.makedirs(args.reports, exist_ok=True)
+    report = os.path.join(args.reports, solver + ".csv")
+    baseline = os.path.join(args.baselines, solver + ".csv")
+    command = [solver_binary(solver, args.build_dir),
+               f"--repeat={args.repeat}", f"--warmup={args.warmup}", f"--threads={args.threads}",
+               f"--report={report}", f"--output={os.path.join(args.reports, solver + '.txt')}",
+               f"--threshold={args.threshold}", f"--noise-ms={args.noise_ms}"]
+    if os.path.exists(baseline) and not args.save_baseline:
+        command.append(f"--baseline={baseline}")
+    command += extra + args.suites
+    print(f"== {solver}")
+    status = subprocess.call(command, stdout=None if args.verbose else subprocess.DEVNULL)
+    if status == 0 and args.save_baseline:
+        os.makedirs(args.baselines, exist_ok=True)
+        shutil.copyfile(report, baseline)
+        print(f"Baseline saved to {baseline}")
+    elif status == 0:
+        print(f"Report written to {report}")
+    return status
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Benchmark SAT solvers over CNF suites and check for regressions.",
+                                     epilog="Arguments after -- are passed to every solver, e.g. -- --two-sat=off")
+    parser.add_argument("--solvers", nargs="+", choices=SOLVERS, default=["cdcl", "dpll"], help="Solvers to run")
+    parser.add_argument("--suites", nargs="+", default=DEFAULT_SUITES, help="CNF files or folders")
+    parser.add_argument("--repeat", type=int, default=5, help="Timed runs per file")
+    parser.add_argument("--warmup", type=int, default=1, help="Untimed runs per file before timing")
+    parser.add_argument("--threads", type=int, default=1, help="Worker threads (1 keeps timings clean)")
+    parser.add_argument("--threshold", type=float, default=0.10, help="Allowed slowdown against the baseline")
+    parser.add_argument("--noise-ms", type=float, default=0.5, help="Slowdowns below this are ignored")
+    parser.add_argument("--build", action="store_true", help="Compile the solvers first")
+    parser.add_argument("--compiler", default="g++", help="Compiler used by --build")
+    parser.add_argument("--build-dir", default=os.path.join(ROOT, "benchmark", "bin"), help="Solver executables")
+    parser.add_argument("--reports", default=os.path.join(ROOT, "benchmark", "reports"), help="Report folder")
+    parser.add_argument("--baselines", default=os.path.join(ROOT, "benchmark", "baseline"), help="Baseline folder")
+    parser.add_argument("--save-baseline", action="store_true", help="Store this run as the new baseline")
+    parser.add_argument("--verbose", action="store_true", help="Show the per-file solver output")
+
+    argv = sys.argv[1:]
+    extra = []
+    if "--" in argv:
+        extra = argv[argv.index("--") + 1:]
+        argv = argv[:argv.index("--")]
+    args = parser.parse_args(argv)
+
+    failed = False
+    for solver in args.solvers:
+        if args.build and not build(solver, args.build_dir, args.compiler):
+            failed = True
+            continue
+        status = run(solver, args, extra)
+        if status == 2:
+            print(f"{solver}: regressions against the baseline")
+        if status != 0:
+            failed = True
+    sys.exit(1 if failed else 0)
@@ -0,0 +1,1271 @@
+#ifndef SAT_SOLVERS_CDCL_CDCL_SOLVER_H
+#define SAT_SOLVERS_CDCL_CDCL_SOLVER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../common/dimacs_parser.h"
+#include "../common/budget.h"
+#include "../common/clause_exchange.h"
+#include "../common/drat_writer.h"
+#include "../common/statistics.h"
+
+ enum RetVal {
+   r_satisfied,
+   r_unsatisfied,
+   r_normal,
+   r_unknown
+ };
+ 
+ enum BranchingHeuristic {
+   b_vsids,
+   b_frequency
+ };
+ 
+ enum RestartPolicy {
+   rs_none,
+   rs_luby,
+   rs_glucose
+ };
+ 
+ // Tunable parts of the search. The learnt clause database is reduced for the
+ // first time after first_reduce conflicts; each later round waits
+ // reduce_increment conflicts longer than the previous one. Learnt clauses
+ // with an LBD of at most glue_lbd are never deleted. Luby restarts happen
+ // after luby_unit times the next Luby sequence term conflicts. Random
+ // choices are drawn from a generator seeded with seed, or from
+ // std::random_device when it is 0. A random_branch_frequency share of the
+ // VSIDS decisions go to a random variable instead. When clauses are shared
+ // between threads, a learnt clause is passed on if it has at most
+ // share_size literals or an LBD of at most share_lbd.
+ struct CDCLOptions {
+   BranchingHeuristic branching_heuristic = BranchingHeuristic::b_vsids;
+   int first_reduce = 2000;
+   int reduce_increment = 300;
+   uint32_t glue_lbd = 2;
+   RestartPolicy restart_policy = RestartPolicy::rs_glucose;
+   int luby_unit = 100;
+   bool phase_saving = true;
+   uint32_t seed = 0;
+   double random_branch_frequency = 0;
+   int share_size = 8;
+   uint32_t share_lbd = 2;
+ };
+ 
+ // Decides when the search should give up its current assignment and start
+ // again from level 0. on_conflict sees the LBD of every learnt clause and
+ // should_restart is asked before each decision.
+ class RestartStrategy {
+ public:
+   virtual ~RestartStrategy() {}
+   virtual void on_conflict(uint32_t) = 0;
+   virtual bool should_restart() = 0;
+   virtual void on_restart() = 0;
+ };
+ 
+ class NoRestart : public RestartStrategy {
+ public:
+   void on_conflict(uint32_t) {}
+   bool should_restart() { return false; }
+   void on_restart() {}
+ };
+ 
+ // Restarts after unit * luby(i) conflicts, where luby(i) is the i-th term of
+ // 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+ class LubyRestart : public RestartStrategy {
+ private:
+   int unit;
+   int restart_index;
+   long long conflicts;
+   long long limit;
+ 
+   static long long luby(int);
+ 
+ public:
+   LubyRestart(int luby_unit) : unit(luby_unit), restart_index(0), conflicts(0) {
+     limit = unit * luby(restart_index);
+   }
+   void on_conflict(uint32_t) { conflicts++; }
+   bool should_restart() { return conflicts >= limit; }
+   void on_restart() {
+     restart_index++;
+     conflicts = 0;
+     limit = unit * luby(restart_index);
+   }
+ };
+ 
+ inline long long LubyRestart::luby(int index) {
+   long long size = 1;
+   int sequence = 0;
+   while (size < index + 1) {
+     sequence++;
+     size = 2 * size + 1;
+   }
+   while (size - 1 != index) {
+     size = (size - 1) / 2;
+     sequence--;
+     index = index % size;
+   }
+   return 1LL << sequence;
+ }
+ 
+ // Glucose-style dynamic restarts: keeps a fast and a slow exponential moving
+ // average of learnt clause LBDs and restarts when recent clauses are clearly
+ // worse than the long-run average, i.e. the search is going nowhere.
+ class GlucoseRestart : public RestartStrategy {
+ private:
+   double fast_average;
+   double slow_average;
+   long long conflicts;
+   int conflicts_since_restart;
+ 
+ public:
+   GlucoseRestart() : fast_average(0), slow_average(0), conflicts(0), conflicts_since_restart(0) {}
+   void on_conflict(uint32_t lbd) {
+     conflicts++;
+     conflicts_since_restart++;
+     // Early on the averages are taken over fewer samples so they are not
+     // biased towards their zero start.
+     fast_average += (lbd - fast_average) / std::min(conflicts, 32LL);
+     slow_average += (lbd - slow_average) / std::min(conflicts, 4096LL);
+   }
+   bool should_restart() {
+     return conflicts_since_restart >= 50 && fast_average * 0.8 > slow_average;
+   }
+   void on_restart() { conflicts_since_restart = 0; }
+ };
+ 
+ // Binary max-heap of variable indices ordered by activity. Positions are
+ // tracked so a bumped variable can be moved up without searching for it.
+ class VariableHeap {
+ private:
+   std::vector<int> heap;
+   std::vector<int> position;
+   const std::vector<double>* activity;
+ 
+   bool before(int, int);
+   void percolate_up(int);
+   void percolate_down(int);
+ 
+ public:
+   void initialize(const std::vector<double>*, int);
+   void grow(int);
+   bool empty();
+   bool contains(int);
+   void insert(int);
+   void increased(int);
+   int pop();
+ };
+ 
+ inline bool VariableHeap::before(int first, int second) {
+   return (*activity)[first] > (*activity)[second];
+ }
+ 
+ inline void VariableHeap::percolate_up(int index) {
+   int variable = heap[index];
+   while (index > 0) {
+     int parent = (index - 1) / 2;
+     if (!before(variable, heap[parent])) break;
+     heap[index] = heap[parent];
+     position[heap[index]] = index;
+     index = parent;
+   }
+   heap[index] = variable;
+   position[variable] = index;
+ }
+ 
+ inline void VariableHeap::percolate_down(int index) {
+   int variable = heap[index];
+   while (2 * index + 1 < heap.size()) {
+     int child = 2 * index + 1;
+     if (child + 1 < heap.size() && before(heap[child + 1], heap[child])) child++;
+     if (!before(heap[child], variable)) break;
+     heap[index] = heap[child];
+     position[heap[index]] = index;
+     index = child;
+   }
+   heap[index] = variable;
+   position[variable] = index;
+ }
+ 
+ inline void VariableHeap::initialize(const std::vector<double>* variable_activity, int variable_count) {
+   activity = variable_activity;
+   heap.clear();
+   position.clear(); position.resize(variable_count, -1);
+   for (int i = 0; i < variable_count; i++) insert(i);
+ }
+ 
+ // Adds the variables from the current count up to the new one.
+ inline void VariableHeap::grow(int variable_count) {
+   int first_new = position.size();
+   position.resize(variable_count, -1);
+   for (int i = first_new; i < variable_count; i++) insert(i);
+ }
+ 
+ inline bool VariableHeap::empty() {
+   return heap.empty();
+ }
+ 
+ inline bool VariableHeap::contains(int variable) {
+   return position[variable] != -1;
+ }
+ 
+ inline void VariableHeap::insert(int variable) {
+   if (contains(variable)) return;
+   heap.push_back(variable);
+   percolate_up(heap.size() - 1);
+ }
+ 
+ inline void VariableHeap::increased(int variable) {
+   if (contains(variable)) percolate_up(position[variable]);
+ }
+ 
+ inline int VariableHeap::pop() {
+   int top = heap[0];
+   position[top] = -1;
+   heap[0] = heap.back();
+   heap.pop_back();
+   if (!heap.empty()) percolate_down(0);
+   return top;
+ }
+ 
+ typedef uint32_t ClauseRef;
+ const ClauseRef no_clause = UINT32_MAX;
+ const int clause_header_words = 2;
+ 
+ // A watch list entry. The blocker is another literal of the clause; while it
+ // is true the clause is satisfied and its literals need not be read. For a
+ // binary clause the blocker is the other literal, so the entry holds the
+ // whole clause.
+ struct Watch {
+   ClauseRef clause_ref;
+   int blocker;
+ };
+ 
+ // A fixed-size record for a three-literal clause: the two literals other
+ // than the one watched. Ternary clauses are watched on all three literals,
+ // so whenever one of them becomes false the other two can be read from the
+ // entry and nothing needs to move to another watch list.
+ struct TernaryWatch {
+   ClauseRef clause_ref;
+   int first;
+   int second;
+ };
+ 
+ // Every clause, original or learnt, lives in one contiguous vector of 32-bit
+ // words: a two-word header followed by the clause literals.
+ //   word 0: size << 3 | relocated << 2 | deleted << 1 | learnt
+ //   word 1: literal block distance of a learnt clause, or the new reference
+ //           once garbage collection has relocated the clause
+ // A ClauseRef is the offset of a header. Allocating may move the memory, so
+ // literal pointers must not be kept across allocate().
+ class ClauseArena {
+ private:
+   std::vector<uint32_t> memory;
+   uint32_t wasted_words;
+ 
+ public:
+   ClauseArena() : wasted_words(0) {}
+   ClauseRef allocate(const int*, int, bool);
+   int size(ClauseRef);
+   bool learnt(ClauseRef);
+   bool deleted(ClauseRef);
+   uint32_t& lbd(ClauseRef);
+   int* literals(ClauseRef);
+   void free(ClauseRef);
+   ClauseRef relocate(ClauseRef, ClauseArena&);
+   uint32_t used_words();
+   uint32_t wasted();
+   void clear();
+   void reserve(uint32_t);
+   void swap(ClauseArena&);
+ };
+ 
+ inline ClauseRef ClauseArena::allocate(const int* clause_literals, int clause_size, bool is_learnt) {
+   ClauseRef clause_ref = memory.size();
+   memory.push_back((uint32_t)clause_size << 3 | (is_learnt ? 1 : 0));
+   memory.push_back(0);
+   for (int i = 0; i < clause_size; i++) memory.push_back((uint32_t)clause_literals[i]);
+   return clause_ref;
+ }
+ 
+ inline int ClauseArena::size(ClauseRef clause_ref) {
+   return memory[clause_ref] >> 3;
+ }
+ 
+ inline bool ClauseArena::learnt(ClauseRef clause_ref) {
+   return memory[clause_ref] & 1;
+ }
+ 
+ inline bool ClauseArena::deleted(ClauseRef clause_ref) {
+   return memory[clause_ref] & 2;
+ }
+ 
+ inline uint32_t& ClauseArena::lbd(ClauseRef clause_ref) {
+   return memory[clause_ref + 1];
+ }
+ 
+ inline int* ClauseArena::literals(ClauseRef clause_ref) {
+   return reinterpret_cast<int*>(&memory[clause_ref + clause_header_words]);
+ }
+ 
+ inline void ClauseArena::free(ClauseRef clause_ref) {
+   memory[clause_ref] |= 2;
+   wasted_words += clause_header_words + size(clause_ref);
+ }
+ 
+ // Copies a clause into the target arena the first time it is reached and
+ // leaves a forwarding reference behind, so every holder of the old reference
+ // ends up pointing at the same copy.
+ inline ClauseRef ClauseArena::relocate(ClauseRef clause_ref, ClauseArena& target) {
+   if (memory[clause_ref] & 4) return memory[clause_ref + 1];
+   ClauseRef new_ref = target.allocate(literals(clause_ref), size(clause_ref), learnt(clause_ref));
+   target.lbd(new_ref) = lbd(clause_ref);
+   memory[clause_ref] |= 4;
+   memory[clause_ref + 1] = new_ref;
+   return new_ref;
+ }
+ 
+ inline uint32_t ClauseArena::used_words() {
+   return memory.size();
+ }
+ 
+ inline uint32_t ClauseArena::wasted() {
+   return wasted_words;
+ }
+ 
+ inline void ClauseArena::clear() {
+   memory.clear();
+   wasted_words = 0;
+ }
+ 
+ inline void ClauseArena::reserve(uint32_t words) {
+   memory.reserve(words);
+ }
+ 
+ inline void ClauseArena::swap(ClauseArena& other) {
+   memory.swap(other.memory);
+   std::swap(wasted_words, other.wasted_words);
+ }
+ 
+ class SATSolverCDCL {
+ private:
+   std::vector<int> literals;
+   ClauseArena clause_arena;
+   std::vector<ClauseRef> clauses;
+   std::vector<ClauseRef> learnts;
+   std::vector<int> literal_frequency;
+   std::vector<int> literal_polarity;
+   std::vector<int> original_literal_frequency;
+   int literal_count;
+   int clause_count;
+   ClauseRef kappa_antecedent;
+   std::vector<int> literal_decision_level;
+   std::vector<ClauseRef> literal_antecedent;
+   std::vector<std::vector<Watch>> watches;
+   std::vector<std::vector<Watch>> binary_watches;
+   std::vector<std::vector<TernaryWatch>> ternary_watches;
+   // Value of each literal by watch index: 1 true, 0 false, -1 unassigned.
+   std::vector<signed char> literal_values;
+   std::vector<int> trail;
+   std::vector<int> trail_limits;
+   int propagation_head;
+   int simplified_trail_size;
+   int assigned_literal_count;
+   bool already_unsatisfied;
+   int pick_counter;
+   CDCLOptions options;
+   int conflict_count;
+   int next_reduce;
+   int reduce_interval;
+   std::vector<int> level_stamp;
+   std::vector<char> seen;
+   std::vector<int> learnt_clause;
+   std::vector<int> analyze_stack;
+   std::vector<int> analyze_toclear;
+   int lbd_stamp;
+   std::vector<double> activity;
+   double activity_increment;
+   double activity_decay;
+   VariableHeap order_heap;
+   std::vector<int> saved_phase;
+   std::vector<bool> model_values;
+   std::vector<int> failed;
+   std::unique_ptr<RestartStrategy> restart_strategy;
+   DratWriter* proof;
+   SolverStatistics own_statistics;
+   SolverStatistics* stats;
+   SolveBudget* budget;
+   long long charged_bytes;
+   ClauseExchange* exchange;
+   int exchange_thread;
+   std::vector<int> imported_clause;
+   std::random_device random_generator;
+   std::mt19937 generator;
+ 
+   int unit_propagate(int);
+   void assign_literal(int, int, ClauseRef);
+   void unassign_literal(int);
+   void backtrack(int);
+   int literal_to_variable_index(int);
+   int literal_to_watch_index(int);
+   int literal_value(int);
+   void watch_clause(ClauseRef);
+   void remove_clause(ClauseRef);
+   void purge_watches();
+   void simplify_at_level_zero();
+   void garbage_collect();
+   uint32_t compute_lbd(const int*, int);
+   void reduce_learnt_clauses();
+   int conflict_analysis_and_backtrack(int);
+   uint32_t abstract_level(int);
+   bool literal_redundant(int, uint32_t);
+   void bump_variable_activity(int);
+   void decay_activity();
+   int pick_branching_variable();
+   int decision_literal(int);
+   int pick_frequency_branching_variable();
+   bool all_variables_assigned();
+   void analyze_final(int);
+   bool out_of_budget();
+   bool import_shared_clauses();
+   int CDCL(const std::vector<int>&);
+ 
+ public:
+   SATSolverCDCL(CDCLOptions solver_options = CDCLOptions())
+       : options(solver_options), proof(nullptr), stats(&own_statistics), budget(nullptr),
+         charged_bytes(0), exchange(nullptr), exchange_thread(0),
+         generator(options.seed != 0 ? options.seed : random_generator()) {
+     initialize(DimacsFormula());
+   }
+   void set_proof(DratWriter* proof_writer) { proof = proof_writer; }
+   // Counts into the given statistics instead of the solver's own.
+   void set_statistics(SolverStatistics* statistics) { stats = statistics; }
+   const SolverStatistics& statistics() const { return *stats; }
+   // Makes solve() give up with r_unknown once the budget is exhausted.
+   void set_budget(SolveBudget* solve_budget) {
+     budget = solve_budget;
+     charged_bytes = 0;
+   }
+   // Shares learnt clauses with the other threads of exchange as the given
+   // thread, and takes theirs in whenever the search is back at level 0.
+   // Every thread must be loaded with the same formula, and none may log a
+   // proof, since the proof would lack the other threads' clauses.
+   void set_clause_exchange(ClauseExchange* clause_exchange, int thread) {
+     exchange = clause_exchange;
+     exchange_thread = thread;
+   }
+   void initialize(const DimacsFormula&);
+   void add_variables(int);
+   bool add_clause(const std::vector<int>&);
+   int solve();
+   int solve(const std::vector<int>&);
+   bool value(int);
+   const std::vector<int>& failed_assumptions();
+   void model(std::vector<bool>&);
+ };
+ 
+ // Drops all clauses, learnt state and heuristics, then loads a formula. The
+ // solver can keep taking clauses and solving afterwards.
+ inline void SATSolverCDCL::initialize(const DimacsFormula& formula) {
+   literal_count = 0;
+   clause_count = 0;
+   assigned_literal_count = 0;
+   kappa_antecedent = no_clause;
+   pick_counter = 0;
+   already_unsatisfied = false;
+   literals.clear();
+   literal_values.clear();
+   literal_frequency.clear();
+   literal_polarity.clear();
+   original_literal_frequency.clear();
+   clause_arena.clear(); clause_arena.reserve(formula.literals.size() + clause_header_words * formula.clause_count());
+   clauses.clear(); clauses.reserve(formula.clause_count());
+   learnts.clear();
+   literal_antecedent.clear();
+   literal_decision_level.clear();
+ 
+   activity.clear();
+   activity_increment = 1.0;
+   activity_decay = 0.95;
+   order_heap.initialize(&activity, 0);
+   saved_phase.clear();
+   model_values.clear();
+   failed.clear();
+   if (options.restart_policy == RestartPolicy::rs_luby) {
+     restart_strategy.reset(new LubyRestart(options.luby_unit));
+   } else if (options.restart_policy == RestartPolicy::rs_glucose) {
+     restart_strategy.reset(new GlucoseRestart());
+   } else {
+     restart_strategy.reset(new NoRestart());
+   }
+   watches.clear();
+   binary_watches.clear();
+   ternary_watches.clear();
+   trail.clear(); trail.reserve(formula.variable_count);
+   trail_limits.clear();
+   propagation_head = 0;
+   simplified_trail_size = 0;
+   conflict_count = 0;
+   reduce_interval = options.first_reduce;
+   next_reduce = options.first_reduce;
+   level_stamp.clear();
+   seen.clear();
+   lbd_stamp = 0;
+ 
+   add_variables(formula.variable_count);
+   std::vector<int> clause;
+   for (int i = 0; i < formula.clause_count(); i++) {
+     clause.assign(formula.clause_begin(i), formula.clause_end(i));
+     add_clause(clause);
+   }
+ }
+ 
+ // Makes variables 1..variable_count available. Variables are also added on
+ // demand by add_clause and solve.
+ inline void SATSolverCDCL::add_variables(int variable_count) {
+   if (variable_count <= literal_count) return;
+   literal_count = variable_count;
+   literals.resize(literal_count, -1);
+   literal_frequency.resize(literal_count, 0);
+   literal_polarity.resize(literal_count, 0);
+   original_literal_frequency.resize(literal_count, 0);
+   literal_antecedent.resize(literal_count, no_clause);
+   literal_decision_level.resize(literal_count, -1);
+   activity.resize(literal_count, 0.0);
+   order_heap.grow(literal_count);
+   saved_phase.resize(literal_count, -1);
+   watches.resize(2 * literal_count);
+   binary_watches.resize(2 * literal_count);
+   ternary_watches.resize(2 * literal_count);
+   literal_values.resize(2 * literal_count, -1);
+   level_stamp.resize(literal_count + 1, 0);
+   seen.resize(literal_count, 0);
+ }
+ 
+ // Adds a clause between searches, when only level 0 is assigned. Literals
+ // false at level 0 are dropped, satisfied clauses and tautologies ignored,
+ // and a unit is assigned at once; it is propagated by the next solve().
+ // Returns false once the clauses added so far are unsatisfiable.
+ inline bool SATSolverCDCL::add_clause(const std::vector<int>& clause_literals) {
+   if (already_unsatisfied) return false;
+   std::vector<int> clause(clause_literals);
+   for (int j = 0; j < clause.size(); j++) add_variables(std::abs(clause[j]));
+   // Watching needs distinct literals, and a tautology can never become unit.
+   std::sort(clause.begin(), clause.end());
+   clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+   int kept_count = 0;
+   for (int j = 0; j < clause.size(); j++) {
+     if (std::binary_search(clause.begin(), clause.end(), -clause[j])) return true;
+     int value = literal_value(clause[j]);
+     if (value == 1) return true;
+     if (value == -1) clause[kept_count++] = clause[j];
+   }
+   if (proof != nullptr && kept_count < clause.size()) proof->add(clause.data(), kept_count);
+   clause.resize(kept_count);
+   if (clause.empty()) {
+     already_unsatisfied = true;
+     return false;
+   }
+   for (int j = 0; j < clause.size(); j++) {
+     int literal_index = literal_to_variable_index(clause[j]);
+     literal_frequency[literal_index]++;
+     original_literal_frequency[literal_index]++;
+     literal_polarity[literal_index] += (clause[j] > 0) ? 1 : -1;
+   }
+   ClauseRef clause_ref = clause_arena.allocate(clause.data(), clause.size(), false);
+   clauses.push_back(clause_ref);
+   clause_count++;
+   SAT_STAT(stats->note_clause_count(clause_count));
+   if (clause.size() == 1) {
+     assign_literal(clause[0], 0, clause_ref);
+   } else {
+     watch_clause(clause_ref);
+   }
+   return true;
+ }
+ 
+ // Registers a clause on the watch lists of its first two literals, each
+ // blocked by the other. Binary clauses go to their own lists, and ternary
+ // clauses to theirs, on all three literals. Unit clauses have nothing to
+ // watch; they are assigned when added.
+ inline void SATSolverCDCL::watch_clause(ClauseRef clause_ref) {
+   int clause_size = clause_arena.size(clause_ref);
+   if (clause_size < 2) return;
+   int* clause = clause_arena.literals(clause_ref);
+   if (clause_size == 3) {
+     ternary_watches[literal_to_watch_index(clause[0])].push_back({clause_ref, clause[1], clause[2]});
+     ternary_watches[literal_to_watch_index(clause[1])].push_back({clause_ref, clause[0], clause[2]});
+     ternary_watches[literal_to_watch_index(clause[2])].push_back({clause_ref, clause[0], clause[1]});
+     return;
+   }
+   std::vector<std::vector<Watch>>& lists = (clause_size == 2) ? binary_watches : watches;
+   lists[literal_to_watch_index(clause[0])].push_back({clause_ref, clause[1]});
+   lists[literal_to_watch_index(clause[1])].push_back({clause_ref, clause[0]});
+ }
+ 
+ // Marks a clause as deleted. Its watches are dropped by the next
+ // purge_watches() and its words are reclaimed by garbage_collect().
+ inline void SATSolverCDCL::remove_clause(ClauseRef clause_ref) {
+   int first_variable = literal_to_variable_index(clause_arena.literals(clause_ref)[0]);
+   if (literal_antecedent[first_variable] == clause_ref) {
+     literal_antecedent[first_variable] = no_clause;
+   }
+   if (proof != nullptr) proof->remove(clause_arena.literals(clause_ref), clause_arena.size(clause_ref));
+   clause_arena.free(clause_ref);
+   clause_count--;
+ }
+ 
+ inline void SATSolverCDCL::purge_watches() {
+   std::vector<std::vector<Watch>>* watch_lists[] = {&watches, &binary_watches};
+   for (std::vector<std::vector<Watch>>* lists : watch_lists) {
+     for (std::vector<Watch>& list : *lists) {
+       int kept_count = 0;
+       for (int j = 0; j < list.size(); j++) {
+         if (!clause_arena.deleted(list[j].clause_ref)) list[kept_count++] = list[j];
+       }
+       list.resize(kept_count);
+     }
+   }
+   for (std::vector<TernaryWatch>& list : ternary_watches) {
+     int kept_count = 0;
+     for (int j = 0; j < list.size(); j++) {
+       if (!clause_arena.deleted(list[j].clause_ref)) list[kept_count++] = list[j];
+     }
+     list.resize(kept_count);
+   }
+ }
+ 
+ // Deletes the clauses satisfied by level 0 assignments, which can never take
+ // part in propagation again. Runs only when level 0 has grown since last time.
+ inline void SATSolverCDCL::simplify_at_level_zero() {
+   if (trail.size() == simplified_trail_size) return;
+   // The proof gets the new level 0 literals as units before their reasons
+   // may be deleted below.
+   for (int i = simplified_trail_size; proof != nullptr && i < trail.size(); i++) proof->add(&trail[i], 1);
+   simplified_trail_size = trail.size();
+   std::vector<ClauseRef>* clause_lists[] = {&clauses, &learnts};
+   for (std::vector<ClauseRef>* clause_list : clause_lists) {
+     int kept_count = 0;
+     for (int i = 0; i < clause_list->size(); i++) {
+       ClauseRef clause_ref = (*clause_list)[i];
+       int* clause = clause_arena.literals(clause_ref);
+       bool satisfied = false;
+       for (int j = 0; j < clause_arena.size(clause_ref) && !satisfied; j++) {
+         satisfied = literal_value(clause[j]) == 1;
+       }
+       if (satisfied) {
+         remove_clause(clause_ref);
+       } else {
+         (*clause_list)[kept_count++] = clause_ref;
+       }
+     }
+     clause_list->resize(kept_count);
+   }
+   purge_watches();
+   if (clause_arena.wasted() > clause_arena.used_words() / 5) garbage_collect();
+ }
+ 
+ // Compacts the arena by copying every live clause into a fresh one. Clauses
+ // are reached through the watch lists first, so clauses watched by the same
+ // literal end up next to each other.
+ inline void SATSolverCDCL::garbage_collect() {
+   ClauseArena compacted;
+   compacted.reserve(clause_arena.used_words() - clause_arena.wasted());
+   for (int i = 0; i < watches.size(); i++) {
+     for (int j = 0; j < watches[i].size(); j++) {
+       watches[i][j].clause_ref = clause_arena.relocate(watches[i][j].clause_ref, compacted);
+     }
+     for (int j = 0; j < binary_watches[i].size(); j++) {
+       binary_watches[i][j].clause_ref = clause_arena.relocate(binary_watches[i][j].clause_ref, compacted);
+     }
+     for (int j = 0; j < ternary_watches[i].size(); j++) {
+       ternary_watches[i][j].clause_ref = clause_arena.relocate(ternary_watches[i][j].clause_ref, compacted);
+     }
+   }
+   for (int i = 0; i < literal_count; i++) {
+     if (literal_antecedent[i] != no_clause) {
+       literal_antecedent[i] = clause_arena.relocate(literal_antecedent[i], compacted);
+     }
+   }
+   for (int i = 0; i < clauses.size(); i++) clauses[i] = clause_arena.relocate(clauses[i], compacted);
+   for (int i = 0; i < learnts.size(); i++) learnts[i] = clause_arena.relocate(learnts[i], compacted);
+   clause_arena.swap(compacted);
+ }
+ 
+ // Literal block distance: the number of distinct decision levels among the
+ // literals of a clause. Clauses spanning few levels tend to be reused often.
+ inline uint32_t SATSolverCDCL::compute_lbd(const int* clause, int clause_size) {
+   lbd_stamp++;
+   uint32_t lbd = 0;
+   for (int i = 0; i < clause_size; i++) {
+     int level = literal_decision_level[literal_to_variable_index(clause[i])];
+     if (level >= 0 && level_stamp[level] != lbd_stamp) {
+       level_stamp[level] = lbd_stamp;
+       lbd++;
+     }
+   }
+   return lbd;
+ }
+ 
+ // Deletes the worse half of the learnt clauses, ranked by LBD with older
+ // clauses going first on ties. Glue clauses and clauses that are currently
+ // the antecedent of an assignment are kept.
+ inline void SATSolverCDCL::reduce_learnt_clauses() {
+   std::stable_sort(learnts.begin(), learnts.end(), [this](ClauseRef first, ClauseRef second) {
+     return clause_arena.lbd(first) > clause_arena.lbd(second);
+   });
+   int delete_limit = learnts.size() / 2, kept_count = 0;
+   for (int i = 0; i < learnts.size(); i++) {
+     ClauseRef clause_ref = learnts[i];
+     int first_variable = literal_to_variable_index(clause_arena.literals(clause_ref)[0]);
+     bool locked = literal_antecedent[first_variable] == clause_ref;
+     if (i < delete_limit && !locked && clause_arena.lbd(clause_ref) > options.glue_lbd) {
+       remove_clause(clause_ref);
+     } else {
+       learnts[kept_count++] = clause_ref;
+     }
+   }
+   learnts.resize(kept_count);
+   purge_watches();
+   if (clause_arena.wasted() > clause_arena.used_words() / 5) garbage_collect();
+   reduce_interval += options.reduce_increment;
+   next_reduce = conflict_count + reduce_interval;
+ }
+ 
+ // Processes the trail from propagation_head onwards. Binary and ternary
+ // clauses are read straight from their watch entries; the clause arena is
+ // only touched to put an implied literal first. A longer clause watching
+ // the literal that just became false is skipped while its blocker is true;
+ // otherwise it either finds a new literal to watch, becomes unit, or is
+ // reported as the conflict.
+ inline int SATSolverCDCL::unit_propagate(int decision_level) {
+   SAT_PHASE_TIMER(stats->propagate_ms);
+   while (propagation_head < trail.size()) {
+     int false_literal = -trail[propagation_head++];
+     SAT_STAT(stats->propagations++);
+     int false_index = literal_to_watch_index(false_literal);
+     for (const Watch& watch : binary_watches[false_index]) {
+       int other_value = literal_value(watch.blocker);
+       if (other_value == 1) continue;
+       if (other_value == 0) {
+         propagation_head = trail.size();
+         kappa_antecedent = watch.clause_ref;
+         return RetVal::r_unsatisfied;
+       }
+       // An antecedent keeps its implied literal first.
+       int* clause = clause_arena.literals(watch.clause_ref);
+       if (clause[0] != watch.blocker) std::swap(clause[0], clause[1]);
+       assign_literal(watch.blocker, decision_level, watch.clause_ref);
+     }
+ 
+     for (const TernaryWatch& watch : ternary_watches[false_index]) {
+       int first_value = literal_value(watch.first);
+       int second_value = literal_value(watch.second);
+       if ((first_value == 1) | (second_value == 1)) continue;
+       // Neither value is 1, so the sum is -2 with both unassigned, -1 with
+       // one false and one unassigned, and 0 with both false.
+       int value_sum = first_value + second_value;
+       if (value_sum == -2) continue;
+       if (value_sum == 0) {
+         propagation_head = trail.size();
+         kappa_antecedent = watch.clause_ref;
+         return RetVal::r_unsatisfied;
+       }
+       int implied = (first_value == -1) ? watch.first : watch.second;
+       int* clause = clause_arena.literals(watch.clause_ref);
+       if (clause[1] == implied) std::swap(clause[0], clause[1]);
+       else if (clause[2] == implied) std::swap(clause[0], clause[2]);
+       assign_literal(implied, decision_level, watch.clause_ref);
+     }
+ 
+     std::vector<Watch>& watch_list = watches[false_index];
+     int i = 0, j = 0;
+     while (i < watch_list.size()) {
+       Watch watch = watch_list[i++];
+       if (literal_value(watch.blocker) == 1) {
+         watch_list[j++] = watch;
+         continue;
+       }
+       ClauseRef clause_ref = watch.clause_ref;
+       int* clause = clause_arena.literals(clause_ref);
+       if (clause[0] == false_literal) std::swap(clause[0], clause[1]);
+       int first_value = literal_value(clause[0]);
+       if (first_value == 1) {
+         watch_list[j++] = {clause_ref, clause[0]};
+         continue;
+       }
+       int clause_size = clause_arena.size(clause_ref);
+       bool new_watch_found = false;
+       for (int k = 2; k < clause_size; k++) {
+         if (literal_value(clause[k]) != 0) {
+           std::swap(clause[1], clause[k]);
+           new_watch_found = true;
+           break;
+         }
+       }
+       if (new_watch_found) {
+         watches[literal_to_watch_index(clause[1])].push_back({clause_ref, clause[0]});
+         continue;
+       }
+       watch_list[j++] = {clause_ref, clause[0]};
+       if (first_value == 0) {
+         while (i < watch_list.size()) watch_list[j++] = watch_list[i++];
+         watch_list.resize(j);
+         propagation_head = trail.size();
+         kappa_antecedent = clause_ref;
+         return RetVal::r_unsatisfied;
+       }
+       assign_literal(clause[0], decision_level, clause_ref);
+     }
+     watch_list.resize(j);
+   }
+   kappa_antecedent = no_clause;
+   return RetVal::r_normal;
+ }
+ 
+ inline void SATSolverCDCL::assign_literal(int variable, int decision_level, ClauseRef antecedent) {
+   int literal = literal_to_variable_index(variable);
+   int value = (variable > 0) ? 1 : 0;
+   literals[literal] = value;
+   literal_values[2 * literal] = value;
+   literal_values[2 * literal + 1] = 1 - value;
+   literal_decision_level[literal] = decision_level;
+   literal_antecedent[literal] = antecedent;
+   literal_frequency[literal] = -1;
+   trail.push_back(variable);
+   assigned_literal_count++;
+ }
+ 
+ inline void SATSolverCDCL::unassign_literal(int literal_index) {
+   saved_phase[literal_index] = literals[literal_index];
+   literals[literal_index] = -1;
+   literal_values[2 * literal_index] = -1;
+   literal_values[2 * literal_index + 1] = -1;
+   literal_decision_level[literal_index] = -1;
+   literal_antecedent[literal_index] = no_clause;
+   literal_frequency[literal_index] = original_literal_frequency[literal_index];
+   order_heap.insert(literal_index);
+   assigned_literal_count--;
+ }
+ 
+ // Undoes every assignment made above the given decision level. The trail
+ // keeps assignments in order and trail_limits[d] marks where level d + 1
+ // starts, so only the literals being undone are visited.
+ inline void SATSolverCDCL::backtrack(int decision_level) {
+   if (trail_limits.size() <= decision_level) return;
+   for (int i = trail.size() - 1; i >= trail_limits[decision_level]; i--) {
+     unassign_literal(literal_to_variable_index(trail[i]));
+   }
+   trail.resize(trail_limits[decision_level]);
+   trail_limits.resize(decision_level);
+   propagation_head = trail.size();
+ }
+ 
+ inline int SATSolverCDCL::literal_to_variable_index(int variable) {
+   return (variable > 0) ? variable - 1 : -variable - 1;
+ }
+ 
+ inline int SATSolverCDCL::literal_to_watch_index(int variable) {
+   return 2 * std::abs(variable) - 2 + (variable < 0);
+ }
+ 
+ // Returns 1 if the literal is true, 0 if it is false and -1 if unassigned.
+ inline int SATSolverCDCL::literal_value(int variable) {
+   return literal_values[literal_to_watch_index(variable)];
+ }
+ 
+ // First-UIP conflict analysis. Walks the trail backwards from the conflict,
+ // resolving away current-level literals marked in seen until only one is
+ // left, then minimizes the clause, backjumps and asserts it. All working
+ // storage is kept in members and reused, so no conflict allocates.
+ inline int SATSolverCDCL::conflict_analysis_and_backtrack(int decision_level) {
+   SAT_PHASE_TIMER(stats->analyze_ms);
+   learnt_clause.clear();
+   learnt_clause.push_back(0);
+   int path_count = 0, implied_literal = 0, trail_index = trail.size() - 1;
+   ClauseRef reason = kappa_antecedent;
+   do {
+     int* clause = clause_arena.literals(reason);
+     int clause_size = clause_arena.size(reason);
+     if (clause_arena.learnt(reason)) {
+       uint32_t lbd = compute_lbd(clause, clause_size);
+       if (lbd < clause_arena.lbd(reason)) clause_arena.lbd(reason) = lbd;
+     }
+     for (int i = 0; i < clause_size; i++) {
+       int literal = clause[i];
+       int literal_index = literal_to_variable_index(literal);
+       if (literal == implied_literal || seen[literal_index] ||
+           literal_decision_level[literal_index] == 0) continue;
+       seen[literal_index] = 1;
+       bump_variable_activity(literal_index);
+       if (literal_decision_level[literal_index] >= decision_level) {
+         path_count++;
+       } else {
+         learnt_clause.push_back(literal);
+       }
+     }
+     while (!seen[literal_to_variable_index(trail[trail_index])]) trail_index--;
+     implied_literal = trail[trail_index--];
+     reason = literal_antecedent[literal_to_variable_index(implied_literal)];
+     seen[literal_to_variable_index(implied_literal)] = 0;
+     path_count--;
+   } while (path_count > 0);
+   learnt_clause[0] = -implied_literal;
+ 
+   // Drop literals implied by the rest of the clause. abstract_levels is a
+   // cheap over-approximation of the levels present, used to stop early.
+   analyze_toclear.assign(learnt_clause.begin(), learnt_clause.end());
+   uint32_t abstract_levels = 0;
+   for (int i = 1; i < learnt_clause.size(); i++) {
+     abstract_levels |= abstract_level(literal_to_variable_index(learnt_clause[i]));
+   }
+   int kept_count = 1;
+   for (int i = 1; i < learnt_clause.size(); i++) {
+     int literal_index = literal_to_variable_index(learnt_clause[i]);
+     if (literal_antecedent[literal_index] == no_clause ||
+         !literal_redundant(learnt_clause[i], abstract_levels)) {
+       learnt_clause[kept_count++] = learnt_clause[i];
+     }
+   }
+   learnt_clause.resize(kept_count);
+   for (int i = 0; i < analyze_toclear.size(); i++) {
+     seen[literal_to_variable_index(analyze_toclear[i])] = 0;
+   }
+ 
+   for (int i = 0; i < learnt_clause.size(); i++) {
+     int literal_index = literal_to_variable_index(learnt_clause[i]);
+     int update = (learnt_clause[i] > 0) ? 1 : -1;
+     literal_polarity[literal_index] += update;
+     if (literal_frequency[literal_index] != -1) literal_frequency[literal_index]++;
+     original_literal_frequency[literal_index]++;
+   }
+   // The asserting literal is already first; put the deepest remaining
+   // literal second, so the watches sit on the two literals that change
+   // after backjumping.
+   int backtracked_decision_level = 0;
+   for (int i = 1; i < learnt_clause.size(); i++) {
+     int literal_index = literal_to_variable_index(learnt_clause[i]);
+     int decision_level_here = literal_decision_level[literal_index];
+     if (decision_level_here > backtracked_decision_level) {
+       backtracked_decision_level = decision_level_here;
+       std::swap(learnt_clause[1], learnt_clause[i]);
+     }
+   }
+   uint32_t lbd = compute_lbd(learnt_clause.data(), learnt_clause.size());
+   SAT_STAT(stats->learnt_clauses++; stats->learnt_literals += learnt_clause.size(); stats->learnt_lbd += lbd);
+   restart_strategy->on_conflict(lbd);
+   if (exchange != nullptr && ((int)learnt_clause.size() <= options.share_size || lbd <= options.share_lbd)) {
+     exchange->publish(exchange_thread, learnt_clause.data(), learnt_clause.size(), lbd);
+     SAT_STAT(stats->exported_clauses++);
+   }
+   backtrack(backtracked_decision_level);
+ 
+   ClauseRef learnt_ref = clause_arena.allocate(learnt_clause.data(), learnt_clause.size(), true);
+   clause_arena.lbd(learnt_ref) = lbd;
+   if (proof != nullptr) proof->add(learnt_clause.data(), learnt_clause.size());
+   learnts.push_back(learnt_ref);
+   clause_count++;
+   SAT_STAT(stats->note_clause_count(clause_count));
+   watch_clause(learnt_ref);
+   decay_activity();
+   assign_literal(learnt_clause[0], backtracked_decision_level, learnt_ref);
+   return backtracked_decision_level;
+ }
+ 
+ inline uint32_t SATSolverCDCL::abstract_level(int literal_index) {
+   return 1u << (literal_decision_level[literal_index] & 31);
+ }
+ 
+ // Checks whether a learnt clause literal follows from the other literals by
+ // following antecedents depth first. Literals proven along the way stay
+ // marked in seen, so later checks can reuse them; a failed check unmarks
+ // whatever it added.
+ inline bool SATSolverCDCL::literal_redundant(int literal, uint32_t abstract_levels) {
+   analyze_stack.clear();
+   analyze_stack.push_back(literal);
+   int top = analyze_toclear.size();
+   while (!analyze_stack.empty()) {
+     int current = analyze_stack.back();
+     analyze_stack.pop_back();
+     ClauseRef reason = literal_antecedent[literal_to_variable_index(current)];
+     int* clause = clause_arena.literals(reason);
+     for (int i = 0; i < clause_arena.size(reason); i++) {
+       int antecedent_literal = clause[i];
+       int literal_index = literal_to_variable_index(antecedent_literal);
+       if (antecedent_literal == -current || seen[literal_index] ||
+           literal_decision_level[literal_index] == 0) continue;
+       if (literal_antecedent[literal_index] != no_clause &&
+           (abstract_level(literal_index) & abstract_levels) != 0) {
+         seen[literal_index] = 1;
+         analyze_stack.push_back(antecedent_literal);
+         analyze_toclear.push_back(antecedent_literal);
+       } else {
+         for (int j = top; j < analyze_toclear.size(); j++) {
+           seen[literal_to_variable_index(analyze_toclear[j])] = 0;
+         }
+         analyze_toclear.resize(top);
+         return false;
+       }
+     }
+   }
+   return true;
+ }
+ 
+ inline void SATSolverCDCL::bump_variable_activity(int literal_index) {
+   activity[literal_index] += activity_increment;
+   if (activity[literal_index] > 1e100) {
+     for (int j = 0; j < literal_count; j++) activity[j] *= 1e-100;
+     activity_increment *= 1e-100;
+   }
+   order_heap.increased(literal_index);
+ }
+ 
+ inline void SATSolverCDCL::decay_activity() {
+   activity_increment /= activity_decay;
+ }
+ 
+ inline int SATSolverCDCL::pick_branching_variable() {
+   SAT_PHASE_TIMER(stats->decide_ms);
+   if (options.branching_heuristic == BranchingHeuristic::b_frequency) {
+     return pick_frequency_branching_variable();
+   }
+   if (options.random_branch_frequency > 0 &&
+       std::uniform_real_distribution<double>(0, 1)(generator) < options.random_branch_frequency) {
+     int variable = std::uniform_int_distribution<int>(0, literal_count - 1)(generator);
+     if (literals[variable] == -1) return decision_literal(variable);
+   }
+   while (!order_heap.empty()) {
+     int variable = order_heap.pop();
+     if (literals[variable] == -1) {
+       return decision_literal(variable);
+     }
+   }
+   return 1;
+ }
+ 
+ // Chooses the polarity of a decision: the value the variable last had when
+ // phase saving is on and it has been assigned before, otherwise the sign it
+ // occurs with most often.
+ inline int SATSolverCDCL::decision_literal(int variable) {
+   if (options.phase_saving && saved_phase[variable] != -1) {
+     return (saved_phase[variable] == 1) ? variable + 1 : -variable - 1;
+   }
+   return (literal_polarity[variable] >= 0) ? variable + 1 : -variable - 1;
+ }
+ 
+ inline int SATSolverCDCL::pick_frequency_branching_variable() {
+   std::uniform_int_distribution<int> choose_branch(1, 10);
+   std::uniform_int_distribution<int> choose_literal(0, literal_count - 1);
+   int random_value = choose_branch(generator);
+   bool too_many_attempts = false;
+   int attempt_counter = 0;
+   do {
+     if (random_value > 4 || assigned_literal_count < literal_count / 2 || too_many_attempts) {
+       pick_counter++;
+       if (pick_counter == 20 * literal_count) {
+         for (int i = 0; i < literals.size(); i++) {
+           original_literal_frequency[i] /= 2;
+           if (literal_frequency[i] != -1) literal_frequency[i] /= 2;
+         }
+         pick_counter = 0;
+       }
+       int variable = std::distance(literal_frequency.begin(),
+                               std::max_element(literal_frequency.begin(), literal_frequency.end()));
+       return decision_literal(variable);
+     } else {
+       while (attempt_counter < 10 * literal_count) {
+         int variable = choose_literal(generator);
+         if (literal_frequency[variable] != -1) {
+           return decision_literal(variable);
+         }
+         attempt_counter++;
+       }
+       too_many_attempts = true;
+     }
+   } while (too_many_attempts);
+   return 1;
+ }
+ 
+ inline bool SATSolverCDCL::all_variables_assigned() {
+   return literal_count == assigned_literal_count;
+ }
+ 
+ // Searches under the given assumptions, which are decided first, one per
+ // decision level; an assumption that is already true gets an empty level.
+ // A false assumption ends the search as unsatisfiable under the
+ // assumptions, while a conflict at level 0 makes the clauses themselves
+ // unsatisfiable for good. Returns at level 0 with the model saved, so
+ // clauses can be added before the next call.
+ inline int SATSolverCDCL::CDCL(const std::vector<int>& assumptions) {
+   failed.clear();
+   if (already_unsatisfied) return RetVal::r_unsatisfied;
+   for (int i = 0; i < assumptions.size(); i++) add_variables(std::abs(assumptions[i]));
+   level_stamp.resize(literal_count + assumptions.size() + 1, 0);
+   int decision_level = 0;
+   if (unit_propagate(decision_level) == RetVal::r_unsatisfied) {
+     already_unsatisfied = true;
+     if (proof != nullptr) proof->add(nullptr, 0);
+     return RetVal::r_unsatisfied;
+   }
+   while (true) {
+     if (decision_level > 0 && restart_strategy->should_restart()) {
+       backtrack(0);
+       decision_level = 0;
+       restart_strategy->on_restart();
+       SAT_STAT(stats->restarts++);
+     }
+     if (decision_level == 0) {
+       if (exchange != nullptr && !import_shared_clauses()) {
+         already_unsatisfied = true;
+         return RetVal::r_unsatisfied;
+       }
+       simplify_at_level_zero();
+     }
+     if (conflict_count >= next_reduce) reduce_learnt_clauses();
+     int picked_variable = 0;
+     while (decision_level < assumptions.size()) {
+       int assumption = assumptions[decision_level];
+       if (literal_value(assumption) == 1) {
+         trail_limits.push_back(trail.size());
+         decision_level++;
+       } else if (literal_value(assumption) == 0) {
+         analyze_final(assumption);
+         backtrack(0);
+         return RetVal::r_unsatisfied;
+       } else {
+         picked_variable = assumption;
+         break;
+       }
+     }
+     if (picked_variable == 0) {
+       if (all_variables_assigned()) break;
+       picked_variable = pick_branching_variable();
+       SAT_STAT(stats->decisions++);
+     }
+     trail_limits.push_back(trail.size());
+     decision_level++;
+     assign_literal(picked_variable, decision_level, no_clause);
+     while (true) {
+       int unit_propagate_result = unit_propagate(decision_level);
+       if (unit_propagate_result == RetVal::r_unsatisfied) {
+         if (decision_level == 0) {
+           already_unsatisfied = true;
+           if (proof != nullptr) proof->add(nullptr, 0);
+           return unit_propagate_result;
+         }
+         conflict_count++;
+         SAT_STAT(stats->conflicts++);
+         if (budget != nullptr && out_of_budget()) {
+           backtrack(0);
+           return RetVal::r_unknown;
+         }
+         decision_level = conflict_analysis_and_backtrack(decision_level);
+       } else break;
+     }
+   }
+   model_values.assign(literal_count + 1, false);
+   for (int i = 0; i < literal_count; i++) model_values[i + 1] = (literals[i] == 1);
+   backtrack(0);
+   return RetVal::r_satisfied;
+ }
+ 
+ // Counts a conflict against the budget after reporting the clause store,
+ // taken as the arena plus two watch references per clause.
+ inline bool SATSolverCDCL::out_of_budget() {
+   long long bytes = 4LL * clause_arena.used_words() + 8LL * clause_count;
+   budget->charge(bytes - charged_bytes);
+   charged_bytes = bytes;
+   return budget->conflict();
+ }
+ 
+ // Adds the clauses the other threads shared since the last call. It runs at
+ // level 0, so literals false there are dropped, satisfied clauses skipped,
+ // and clauses left with one literal assigned as level 0 units. The rest
+ // become learnt clauses with the sender's LBD. Returns false if a clause is
+ // falsified or propagating the new units leads to a conflict.
+ inline bool SATSolverCDCL::import_shared_clauses() {
+   bool conflict = false;
+   exchange->collect(exchange_thread, [&](const int* clause, int clause_size, uint32_t lbd) {
+     if (conflict) return;
+     imported_clause.clear();
+     for (int i = 0; i < clause_size; i++) {
+       if (std::abs(clause[i]) > literal_count) return;
+       int value = literal_value(clause[i]);
+       if (value == 1) return;
+       if (value == -1) imported_clause.push_back(clause[i]);
+     }
+     SAT_STAT(stats->imported_clauses++);
+     if (imported_clause.empty()) {
+       conflict = true;
+     } else if (imported_clause.size() == 1) {
+       assign_literal(imported_clause[0], 0, no_clause);
+     } else {
+       ClauseRef clause_ref = clause_arena.allocate(imported_clause.data(), imported_clause.size(), true);
+       clause_arena.lbd(clause_ref) = std::min<uint32_t>(lbd, imported_clause.size());
+       learnts.push_back(clause_ref);
+       clause_count++;
+       watch_clause(clause_ref);
+     }
+   });
+   return !conflict && unit_propagate(0) != RetVal::r_unsatisfied;
+ }
+ 
+ // Collects the assumptions responsible for the false assumption: those
+ // whose decisions the implication of its negation goes back to, plus the
+ // assumption itself. Only assumptions are decided below it on the trail.
+ inline void SATSolverCDCL::analyze_final(int assumption) {
+   failed.assign(1, assumption);
+   int assumption_index = literal_to_variable_index(assumption);
+   if (literal_decision_level[assumption_index] == 0) return;
+   seen[assumption_index] = 1;
+   for (int i = trail.size() - 1; i >= trail_limits[0]; i--) {
+     int literal_index = literal_to_variable_index(trail[i]);
+     if (!seen[literal_index]) continue;
+     ClauseRef reason = literal_antecedent[literal_index];
+     if (reason == no_clause) {
+       failed.push_back(trail[i]);
+     } else {
+       int* clause = clause_arena.literals(reason);
+       for (int j = 0; j < clause_arena.size(reason); j++) {
+         int other_index = literal_to_variable_index(clause[j]);
+         if (literal_decision_level[other_index] > 0) seen[other_index] = 1;
+       }
+     }
+     seen[literal_index] = 0;
+   }
+ }
+ 
+ inline int SATSolverCDCL::solve() {
+   return CDCL(std::vector<int>());
+ }
+ 
+ // Solves the clauses added so far with every assumption literal forced true
+ // for this call only. Learnt clauses, activities and saved phases carry
+ // over to later calls.
+ inline int SATSolverCDCL::solve(const std::vector<int>& assumptions) {
+   return CDCL(assumptions);
+ }
+ 
+ // Value of a variable in the model found by the last satisfiable solve().
+ inline bool SATSolverCDCL::value(int variable) {
+   return variable < model_values.size() && model_values[variable];
+ }
+ 
+ // After solve() returned unsatisfiable because of the assumptions, a
+ // subset of them that cannot all hold; empty if no assumptions are needed
+ // for the conflict.
+ inline const std::vector<int>& SATSolverCDCL::failed_assumptions() {
+   return failed;
+ }
+ 
+ // Fills model[v] for v in 1..literal_count after a satisfiable solve().
+ inline void SATSolverCDCL::model(std::vector<bool>& model) {
+   model = model_values;
+ }
+
+#endif
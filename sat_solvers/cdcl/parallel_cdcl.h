@@ -0,0 +1,92 @@
+#ifndef SAT_SOLVERS_CDCL_PARALLEL_CDCL_H
+#define SAT_SOLVERS_CDCL_PARALLEL_CDCL_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/budget.h"
+#include "../common/clause_exchange.h"
+#include "../common/dimacs_parser.h"
+#include "../common/statistics.h"
+#include "cdcl_solver.h"
+
+// The options thread runs with in a parallel search. Thread 0 keeps the
+// given ones. The others take the next seeds, send 2% of their decisions
+// to random variables, and every second one swaps glucose and Luby
+// restarts, so that they do not all walk the same path.
+inline CDCLOptions parallel_thread_options(const CDCLOptions &options, int thread) {
+    CDCLOptions thread_options = options;
+    if (thread == 0) return thread_options;
+    if (options.seed != 0) thread_options.seed = options.seed + thread;
+    if (thread_options.random_branch_frequency == 0) thread_options.random_branch_frequency = 0.02;
+    if (thread % 2 == 1 && options.restart_policy == RestartPolicy::rs_glucose) {
+        thread_options.restart_policy = RestartPolicy::rs_luby;
+    } else if (thread % 2 == 1 && options.restart_policy == RestartPolicy::rs_luby) {
+        thread_options.restart_policy = RestartPolicy::rs_glucose;
+    }
+    return thread_options;
+}
+
+struct ParallelCDCLResult {
+    // "SAT" or "UNSAT" once a thread has answered, otherwise the budget
+    // outcome, e.g. "TIMEOUT".
+    std::string outcome;
+    std::vector<bool> model;
+    // The statistics of the thread that answered, or of thread 0.
+    SolverStatistics statistics;
+};
+
+// Searches formula with threads CDCL solvers at once, each with its own
+// trail, heuristics and clause database. They pass short and low-LBD
+// learnt clauses to each other through a ClauseExchange and take the
+// others' in at every restart. The first thread to answer raises a shared
+// stop flag, which the rest see at their next conflict. Every thread gets
+// its own copy of budget, so the limits apply to each of them.
+inline ParallelCDCLResult solve_parallel_cdcl(const DimacsFormula &formula, const CDCLOptions &options, int threads,
+                                              const SolveBudget &budget) {
+    if (threads < 1) threads = 1;
+    ClauseExchange exchange(threads);
+    std::vector<SolveBudget> budgets(threads, budget);
+    std::vector<SolverStatistics> statistics(threads);
+    std::atomic<bool> stop(false);
+    std::mutex result_lock;
+    ParallelCDCLResult result;
+    int winner = -1;
+
+    auto search = [&](int thread) {
+        budgets[thread].set_stop_flag(&stop);
+        SATSolverCDCL solver(parallel_thread_options(options, thread));
+        solver.set_statistics(&statistics[thread]);
+        solver.set_budget(&budgets[thread]);
+        solver.set_clause_exchange(&exchange, thread);
+        solver.initialize(formula);
+        int outcome = solver.solve();
+        if (outcome == RetVal::r_unknown || budgets[thread].state() != SolveBudget::within_budget) return;
+        std::lock_guard<std::mutex> guard(result_lock);
+        if (winner >= 0) return;
+        winner = thread;
+        result.outcome = outcome == RetVal::r_satisfied ? "SAT" : "UNSAT";
+        if (outcome == RetVal::r_satisfied) solver.model(result.model);
+        stop.store(true, std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> workers;
+    for (int thread = 1; thread < threads; thread++) workers.emplace_back(search, thread);
+    search(0);
+    for (auto &worker : workers) worker.join();
+
+    result.statistics = statistics[winner >= 0 ? winner : 0];
+    if (winner >= 0) return result;
+    bool out_of_time = false, out_of_memory = false;
+    for (const auto &thread_budget : budgets) {
+        out_of_time |= thread_budget.state() == SolveBudget::out_of_time;
+        out_of_memory |= thread_budget.state() == SolveBudget::out_of_memory;
+    }
+    result.outcome = out_of_time ? "TIMEOUT" : out_of_memory ? "MEMOUT" : "UNKNOWN";
+    return result;
+}
+
+#endif
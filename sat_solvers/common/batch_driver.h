@@ -0,0 +1,428 @@
+#ifndef SAT_SOLVERS_COMMON_BATCH_DRIVER_H
+#define SAT_SOLVERS_COMMON_BATCH_DRIVER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "budget.h"
+#include "components.h"
+#include "dimacs_parser.h"
+#include "preprocessor.h"
+#include "statistics.h"
+#include "two_sat.h"
+#include "work_stealing_pool.h"
+
+// Command line shared by every solver executable:
+//   sat_solver [--threads=N] [--output=FILE] [--two-sat=auto|off]
+//              [--preprocess=on|off] [--decompose=on|off] [--proof=DIR]
+//              [benchmark options] [solver options] [PATH...]
+// Each PATH is a .cnf file or a directory whose .cnf files are all solved.
+// Without paths the default folder is used, and --threads=0 means one
+// thread per hardware core. Formulas whose clauses all have at most two
+// literals go to the linear-time 2-SAT engine unless --two-sat=off is given.
+// --preprocess=on simplifies each formula before it is solved.
+// --decompose=on solves the variable-disjoint parts of each formula
+// separately, on --component-threads=N threads. By default that is one per
+// core when each formula would otherwise get one thread, and one when the
+// files are solved in parallel or the solver is already multi-threaded.
+// --proof=DIR writes <name>.model for every model found and asks the
+// solver for a <name>.drat proof; it turns preprocessing, decomposition
+// and 2-SAT dispatch off, since their steps would be missing from the
+// proof.
+//
+// Benchmark mode starts with --repeat=N. Each file is then parsed and
+// solved --warmup=W untimed times (default 1) and N timed times, and the
+// min/median/p95 of parse and solve time go to --report=FILE (.csv or
+// .json). --baseline=FILE compares the medians with an earlier CSV report
+// and flags any that are more than --threshold (a fraction, default 0.10)
+// and --noise-ms (default 0.5) slower, along with changed outcomes.
+//
+// --time-limit=SECONDS, --conflict-limit=N and --memory-limit=MB bound each
+// run. A run that hits one is reported as TIMEOUT, UNKNOWN or MEMOUT and
+// the batch moves on to the next file.
+struct BatchOptions {
+    std::vector<std::string> inputs;
+    std::string default_input = "../../cnf_files/samples/";
+    std::string output_path;
+    int threads = 1;
+    bool two_sat_dispatch = true;
+    bool preprocess = false;
+    bool decompose = false;
+    // 0 picks the default described above.
+    int component_threads = 0;
+    // Threads a solver uses for one formula, e.g. its --parallel=N. Solvers
+    // that start threads of their own set this before run_batch.
+    int solver_threads = 1;
+    std::string proof_directory;
+    int repetitions = 0;
+    int warmup = 1;
+    std::string report_path;
+    std::string baseline_path;
+    double regression_threshold = 0.10;
+    double noise_ms = 0.5;
+    BudgetLimits limits;
+};
+
+// What a solver is told about the instance besides its formula.
+// proof_path is where a solver that can log a DRAT proof should write it,
+// or empty if no proof is wanted. A solver adds its counters to statistics
+// and checks its limits against budget; both are fresh for every run and
+// never null. A solver that stops because the budget is exhausted may
+// return any outcome, since the driver reports the budget's instead.
+struct SolveContext {
+    std::string name;
+    std::string proof_path;
+    SolverStatistics *statistics = nullptr;
+    SolveBudget *budget = nullptr;
+};
+
+// Solves one parsed formula and returns its outcome as printed, e.g. "SAT".
+// A solver that finds a model may store it as model[v] for v in
+// 1..variable_count; otherwise it leaves model empty.
+using SolveFunction = std::function<std::string(const DimacsFormula &, const SolveContext &, std::vector<bool> &)>;
+// Returns false for an option the solver does not know.
+using OptionHandler = std::function<bool(const std::string &)>;
+
+inline bool parse_batch_arguments(int argc, char *argv[], BatchOptions &options,
+                                  const OptionHandler &handle_option = nullptr) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--threads=", 0) == 0) {
+            options.threads = std::stoi(arg.substr(10));
+            if (options.threads <= 0) options.threads = std::max(1u, std::thread::hardware_concurrency());
+        } else if (arg.rfind("--output=", 0) == 0) {
+            options.output_path = arg.substr(9);
+        } else if (arg == "--two-sat=auto" || arg == "--two-sat=off") {
+            options.two_sat_dispatch = (arg == "--two-sat=auto");
+        } else if (arg == "--preprocess=on" || arg == "--preprocess=off") {
+            options.preprocess = (arg == "--preprocess=on");
+        } else if (arg == "--decompose=on" || arg == "--decompose=off") {
+            options.decompose = (arg == "--decompose=on");
+        } else if (arg.rfind("--component-threads=", 0) == 0) {
+            options.component_threads = std::max(0, std::stoi(arg.substr(20)));
+        } else if (arg.rfind("--proof=", 0) == 0) {
+            options.proof_directory = arg.substr(8);
+        } else if (arg.rfind("--repeat=", 0) == 0) {
+            options.repetitions = std::max(0, std::stoi(arg.substr(9)));
+        } else if (arg.rfind("--warmup=", 0) == 0) {
+            options.warmup = std::max(0, std::stoi(arg.substr(9)));
+        } else if (arg.rfind("--report=", 0) == 0) {
+            options.report_path = arg.substr(9);
+        } else if (arg.rfind("--baseline=", 0) == 0) {
+            options.baseline_path = arg.substr(11);
+        } else if (arg.rfind("--threshold=", 0) == 0) {
+            options.regression_threshold = std::stod(arg.substr(12));
+        } else if (arg.rfind("--noise-ms=", 0) == 0) {
+            options.noise_ms = std::stod(arg.substr(11));
+        } else if (arg.rfind("--time-limit=", 0) == 0) {
+            options.limits.seconds = std::stod(arg.substr(13));
+        } else if (arg.rfind("--conflict-limit=", 0) == 0) {
+            options.limits.conflicts = std::stoll(arg.substr(17));
+        } else if (arg.rfind("--memory-limit=", 0) == 0) {
+            options.limits.memory_bytes = std::stoll(arg.substr(15)) * 1024 * 1024;
+        } else if (arg.rfind("--", 0) != 0) {
+            options.inputs.push_back(arg);
+        } else if (!handle_option || !handle_option(arg)) {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (!options.proof_directory.empty()) {
+        options.preprocess = false;
+        options.decompose = false;
+        options.two_sat_dispatch = false;
+    }
+    return true;
+}
+
+// Solves one formula with the 2-SAT engine if it applies and with solve
+// otherwise. A run stopped by its budget gets the budget's outcome and no
+// model.
+inline std::string solve_formula(const BatchOptions &options, const SolveFunction &solve,
+                                 const DimacsFormula &formula, const SolveContext &context,
+                                 std::vector<bool> &model) {
+    if (options.two_sat_dispatch && is_two_sat(formula)) return solve_two_sat(formula, model) ? "SAT" : "UNSAT";
+    std::string outcome = solve(formula, context, model);
+    if (context.budget->state() != SolveBudget::within_budget) {
+        model.clear();
+        return context.budget->outcome();
+    }
+    return outcome;
+}
+
+// Threads solve_components uses. Without --component-threads, it takes all
+// cores only when nothing else solving the formula runs in parallel, so
+// that the batch pool, the components and the solver's own threads do not
+// multiply.
+inline int component_thread_count(const BatchOptions &options) {
+    if (options.component_threads > 0) return options.component_threads;
+    if (options.threads > 1 || options.solver_threads > 1) return 1;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Solves the connected components of a formula as separate formulas,
+// smallest first, on a work stealing pool. Small components are usually
+// quick, and an UNSAT one among them saves solving the big ones, which a
+// single thread would otherwise have to finish first. Each component gets
+// a copy of the budget and its own statistics, which are then added to the
+// context's. The first UNSAT component raises a stop flag that skips the
+// components not started yet and stops the running ones at their next
+// budget check, also inside solvers that race threads with stop flags of
+// their own. The formula is SAT when every component is, and the models
+// of the components are merged into one, unless one of them gave none.
+// Any other outcome of a component, such as TIMEOUT, becomes the outcome
+// of the formula.
+inline std::string solve_components(const BatchOptions &options, const SolveFunction &solve,
+                                    const DimacsFormula &formula, const SolveContext &context,
+                                    std::vector<bool> &model) {
+    std::vector<FormulaComponent> components = split_components(formula);
+    if (components.size() <= 1) return solve_formula(options, solve, formula, context, model);
+
+    struct ComponentRun {
+        std::string outcome;
+        std::vector<bool> model;
+        SolverStatistics statistics;
+        SolveBudget budget;
+    };
+    std::vector<ComponentRun> runs(components.size());
+    std::atomic<bool> stop(false);
+    WorkStealingPool pool(component_thread_count(options));
+    pool.run(components.size(), [&](int, size_t i) {
+        if (stop.load(std::memory_order_relaxed)) return;
+        ComponentRun &run = runs[i];
+        run.budget = *context.budget;
+        run.budget.set_stop_flag(&stop);
+        SolveContext component_context = context;
+        component_context.statistics = &run.statistics;
+        component_context.budget = &run.budget;
+        run.outcome = solve_formula(options, solve, components[i].formula, component_context, run.model);
+        if (run.outcome == "UNSAT") stop.store(true, std::memory_order_relaxed);
+    });
+
+    for (const auto &run : runs) context.statistics->merge(run.statistics);
+    for (const auto &run : runs)
+        if (run.outcome == "UNSAT") return run.outcome;
+    for (const auto &run : runs)
+        if (run.outcome != "SAT") return run.outcome;
+    model.assign(formula.variable_count + 1, false);
+    for (size_t i = 0; i < components.size(); i++) {
+        const std::vector<int> &variables = components[i].variables;
+        if (runs[i].model.size() < variables.size()) {
+            model.clear();
+            break;
+        }
+        for (size_t local = 1; local < variables.size(); local++) model[variables[local]] = runs[i].model[local];
+    }
+    return "SAT";
+}
+
+// Writes a model in the SAT competition output format.
+inline bool write_model(const std::string &path, const std::vector<bool> &model) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    out << "s SATISFIABLE\nv";
+    for (size_t v = 1; v < model.size(); v++) out << ' ' << (model[v] ? (long long)v : -(long long)v);
+    out << " 0\n";
+    return true;
+}
+
+// Expands the input paths into the list of .cnf files to solve. Files in a
+// directory are taken in name order so the output does not depend on the
+// file system.
+inline bool collect_cnf_files(const BatchOptions &options, std::vector<std::filesystem::path> &files) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> inputs = options.inputs;
+    if (inputs.empty()) inputs.push_back(options.default_input);
+    for (const auto &input : inputs) {
+        if (fs::is_directory(input)) {
+            std::vector<fs::path> found;
+            for (const auto &entry : fs::directory_iterator(input)) {
+                if (entry.path().extension() == ".cnf") found.push_back(entry.path());
+            }
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else if (fs::is_regular_file(input)) {
+            files.push_back(input);
+        } else {
+            std::cerr << "Error: not a file or directory: " << input << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Solves every input file and writes "<file>: <outcome> in x ms" lines, in
+// input order, to the output file. The time covers preprocessing and
+// solving, not parsing; in benchmark mode it is the median over the timed
+// runs. A model found for a preprocessed formula is extended to the
+// original variables, and every model is checked against the original
+// formula. Returns 2 if a benchmark baseline comparison found regressions.
+// Files are scheduled largest first across a work stealing pool so a big
+// instance is not left to run alone at the end. Built with
+// SAT_SOLVER_STATISTICS, each line ends with the statistics of the last
+// run. Lines are also echoed to stdout as instances finish; files that
+// fail to parse get no line.
+inline int run_batch(const BatchOptions &options, const SolveFunction &solve) {
+    std::vector<std::filesystem::path> files;
+    if (!collect_cnf_files(options, files)) return 1;
+    if (!options.proof_directory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(options.proof_directory, error);
+    }
+
+    std::vector<size_t> order(files.size());
+    std::vector<uintmax_t> sizes(files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        order[i] = i;
+        std::error_code error;
+        sizes[i] = std::filesystem::file_size(files[i], error);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    std::map<std::string, BenchmarkRecord> baseline;
+    if (!options.baseline_path.empty() && !read_benchmark_baseline(options.baseline_path, baseline)) {
+        std::cerr << "Error: cannot read baseline " << options.baseline_path << "\n";
+        return 1;
+    }
+
+    using Clock = std::chrono::high_resolution_clock;
+    bool benchmark = options.repetitions > 0;
+    int runs = benchmark ? options.warmup + options.repetitions : 1;
+    std::vector<std::string> lines(files.size());
+    std::vector<BenchmarkRecord> records(files.size());
+    std::vector<char> solved(files.size(), 0);
+    std::mutex print_lock;
+    WorkStealingPool pool(options.threads);
+    pool.run(order.size(), [&](int, size_t task) {
+        size_t index = order[task];
+        SolveContext context;
+        context.name = files[index].filename().string();
+        std::string model_path;
+        if (!options.proof_directory.empty()) {
+            std::filesystem::path stem = std::filesystem::path(options.proof_directory) / files[index].stem();
+            context.proof_path = stem.string() + ".drat";
+            model_path = stem.string() + ".model";
+        }
+
+        std::vector<double> parse_times, solve_times;
+        DimacsFormula formula;
+        std::string outcome;
+        std::vector<bool> model;
+        SolverStatistics statistics;
+        context.statistics = &statistics;
+        SolveBudget budget;
+        context.budget = &budget;
+        for (int run = 0; run < runs; run++) {
+            statistics = SolverStatistics();
+            auto parse_start = Clock::now();
+            std::string error;
+            if (!parse_dimacs_file(files[index].string(), formula, error)) {
+                std::lock_guard<std::mutex> guard(print_lock);
+                std::cerr << "Failed to parse " << files[index].string() << ": " << error << "\n";
+                return;
+            }
+            auto start = Clock::now();
+            budget = SolveBudget(options.limits);
+            DimacsFormula simplified;
+            ModelReconstruction reconstruction;
+            if (options.preprocess) {
+                simplified = formula;
+                SAT_PHASE_TIMER(statistics.preprocess_ms);
+                preprocess(simplified, reconstruction);
+            }
+            const DimacsFormula &input = options.preprocess ? simplified : formula;
+            model.clear();
+            std::string run_outcome = options.decompose ? solve_components(options, solve, input, context, model)
+                                                        : solve_formula(options, solve, input, context, model);
+            if (run_outcome == "SAT" && !model.empty()) reconstruction.extend(model);
+            auto end = Clock::now();
+            statistics.parse_ms = std::chrono::duration<double, std::milli>(start - parse_start).count();
+            if (run >= runs - std::max(options.repetitions, 1)) {
+                parse_times.push_back(std::chrono::duration<double, std::milli>(start - parse_start).count());
+                solve_times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+            if (run > 0 && run_outcome != outcome) {
+                std::lock_guard<std::mutex> guard(print_lock);
+                std::cerr << "Outcome changed between runs for " << files[index].string() << "\n";
+            }
+            outcome = run_outcome;
+        }
+
+        if (outcome == "SAT" && !model.empty() && !formula.satisfied_by(model)) {
+            std::lock_guard<std::mutex> guard(print_lock);
+            std::cerr << "Model check failed for " << files[index].string() << "\n";
+        }
+        if (outcome == "SAT" && !model.empty() && !model_path.empty() && !write_model(model_path, model)) {
+            std::lock_guard<std::mutex> guard(print_lock);
+            std::cerr << "Error: cannot write " << model_path << "\n";
+        }
+
+        BenchmarkRecord &record = records[index];
+        record.file = context.name;
+        record.outcome = outcome;
+        record.runs = solve_times.size();
+        record.parse = summarize_timings(parse_times);
+        record.solve = summarize_timings(solve_times);
+        solved[index] = 1;
+
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(3);
+        line << context.name << ": " << outcome << " in " << record.solve.median << " ms";
+#ifdef SAT_SOLVER_STATISTICS
+        statistics.peak_rss_kb = peak_rss_kb();
+        line << " [" << statistics.summary() << "]";
+#endif
+        line << "\n";
+        lines[index] = line.str();
+        std::lock_guard<std::mutex> guard(print_lock);
+        std::cout << lines[index] << std::flush;
+    });
+
+    int status = 0;
+    if (benchmark) {
+        std::vector<BenchmarkRecord> finished;
+        for (size_t i = 0; i < files.size(); i++)
+            if (solved[i]) finished.push_back(records[i]);
+        if (!options.report_path.empty()) {
+            if (write_benchmark_report(options.report_path, finished)) {
+                std::cout << "Benchmark report written to " << options.report_path << "\n";
+            } else {
+                std::cerr << "Error: cannot write " << options.report_path << "\n";
+                status = 1;
+            }
+        }
+        if (!options.baseline_path.empty()) {
+            std::vector<std::string> problems = compare_with_baseline(finished, baseline, options.regression_threshold,
+                                                                      options.noise_ms);
+            for (const auto &problem : problems) std::cout << "REGRESSION " << problem << "\n";
+            std::cout << problems.size() << " regression(s) against " << options.baseline_path << "\n";
+            if (!problems.empty() && status == 0) status = 2;
+        }
+    }
+
+    std::ofstream out(options.output_path);
+    if (!out.is_open()) {
+        std::cerr << "Error: cannot write " << options.output_path << "\n";
+        return 1;
+    }
+    for (const auto &line : lines) out << line;
+    out.close();
+    std::cout << "Results written to " << options.output_path << "\n";
+    return status;
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef SAT_SOLVERS_COMMON_BENCHMARK_H
+#define SAT_SOLVERS_COMMON_BENCHMARK_H
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Min, median and 95th percentile of a set of timings in milliseconds. The
+// percentile uses the nearest rank, so with fewer than 20 samples it is the
+// slowest sample.
+struct TimingSummary {
+    double min = 0;
+    double median = 0;
+    double p95 = 0;
+};
+
+inline TimingSummary summarize_timings(std::vector<double> samples) {
+    TimingSummary summary;
+    if (samples.empty()) return summary;
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    summary.min = samples[0];
+    summary.median = (n % 2 == 1) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    size_t rank = (size_t)std::ceil(0.95 * n);
+    summary.p95 = samples[std::max<size_t>(rank, 1) - 1];
+    return summary;
+}
+
+// The measurements of one instance over all timed repetitions.
+struct BenchmarkRecord {
+    std::string file;
+    std::string outcome;
+    int runs = 0;
+    TimingSummary parse;
+    TimingSummary solve;
+};
+
+inline const char *benchmark_csv_header() {
+    return "file,outcome,runs,parse_min_ms,parse_median_ms,parse_p95_ms,solve_min_ms,solve_median_ms,solve_p95_ms";
+}
+
+// Writes the records as JSON if path ends in ".json", otherwise as CSV with
+// benchmark_csv_header() as the first line.
+inline bool write_benchmark_report(const std::string &path, const std::vector<BenchmarkRecord> &records) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    out << std::fixed << std::setprecision(4);
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    if (json) {
+        out << "[\n";
+        for (size_t i = 0; i < records.size(); i++) {
+            const BenchmarkRecord &r = records[i];
+            out << "  {\"file\": \"" << r.file << "\", \"outcome\": \"" << r.outcome << "\", \"runs\": " << r.runs
+                << ", \"parse_ms\": {\"min\": " << r.parse.min << ", \"median\": " << r.parse.median
+                << ", \"p95\": " << r.parse.p95 << "}, \"solve_ms\": {\"min\": " << r.solve.min
+                << ", \"median\": " << r.solve.median << ", \"p95\": " << r.solve.p95 << "}}"
+                << (i + 1 < records.size() ? ",\n" : "\n");
+        }
+        out << "]\n";
+    } else {
+        out << benchmark_csv_header() << "\n";
+        for (const auto &r : records) {
+            out << r.file << ',' << r.outcome << ',' << r.runs << ',' << r.parse.min << ',' << r.parse.median << ','
+                << r.parse.p95 << ',' << r.solve.min << ',' << r.solve.median << ',' << r.solve.p95 << "\n";
+        }
+    }
+    return true;
+}
+
+// Reads a CSV report written by write_benchmark_report, keyed by file name.
+inline bool read_benchmark_baseline(const std::string &path, std::map<std::string, BenchmarkRecord> &baseline) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    std::string line;
+    if (!std::getline(in, line) || line != benchmark_csv_header()) return false;
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::stringstream row(line);
+        std::string field;
+        while (std::getline(row, field, ',')) fields.push_back(field);
+        if (fields.size() != 9) return false;
+        BenchmarkRecord r;
+        r.file = fields[0];
+        r.outcome = fields[1];
+        r.runs = std::stoi(fields[2]);
+        r.parse = {std::stod(fields[3]), std::stod(fields[4]), std::stod(fields[5])};
+        r.solve = {std::stod(fields[6]), std::stod(fields[7]), std::stod(fields[8])};
+        baseline[r.file] = r;
+    }
+    return true;
+}
+
+// Compares median parse and solve times with the baseline. A time regresses
+// when it is more than threshold (a fraction) above the baseline and also
+// more than noise_ms slower, so microsecond instances do not trip it on
+// jitter. A changed SAT/UNSAT outcome is always reported. Returns one
+// message per problem.
+inline std::vector<std::string> compare_with_baseline(const std::vector<BenchmarkRecord> &records,
+                                                      const std::map<std::string, BenchmarkRecord> &baseline,
+                                                      double threshold, double noise_ms) {
+    std::vector<std::string> problems;
+    auto check = [&](const std::string &file, const char *phase, double now, double before) {
+        if (now > before * (1 + threshold) && now - before > noise_ms) {
+            std::ostringstream message;
+            message << std::fixed << std::setprecision(3) << file << ": " << phase << " median " << before
+                    << " ms -> " << now << " ms (+" << std::setprecision(1) << 100 * (now / before - 1) << "%)";
+            problems.push_back(message.str());
+        }
+    };
+    for (const auto &r : records) {
+        auto found = baseline.find(r.file);
+        if (found == baseline.end()) continue;
+        const BenchmarkRecord &before = found->second;
+        if (r.outcome != before.outcome) {
+            problems.push_back(r.file + ": outcome " + before.outcome + " -> " + r.outcome);
+        }
+        check(r.file, "parse", r.parse.median, before.parse.median);
+        check(r.file, "solve", r.solve.median, before.solve.median);
+    }
+    return problems;
+}
+
+#endif
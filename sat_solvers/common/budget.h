@@ -0,0 +1,112 @@
+#ifndef SAT_SOLVERS_COMMON_BUDGET_H
+#define SAT_SOLVERS_COMMON_BUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Per-instance limits. Zero means no limit.
+struct BudgetLimits {
+    double seconds = 0;
+    long long conflicts = 0;
+    long long memory_bytes = 0;
+};
+
+// Tracks one solver run against its limits. Solvers call the check
+// functions from their main loops and give up as soon as one returns true;
+// nothing interrupts them from outside. Memory is the size of the clause
+// store as the solver reports it through charge() and release(), not what
+// the process has allocated. Another thread can still stop a run early by
+// raising the stop flag given to set_stop_flag(); the run sees it at its
+// next check. A budget is used by one thread, but copies of it share the
+// deadline and the stop flag, so each of several racing runs can get its
+// own. A copy that gets a stop flag of its own keeps watching the one it
+// was copied with, so a race nested in another still stops with the outer
+// one.
+class SolveBudget {
+public:
+    enum Status { within_budget, out_of_time, out_of_conflicts, out_of_memory, cancelled };
+
+private:
+    // The clock is read once per this many checks, so a check costs a
+    // counter decrement on the hot path.
+    static const int clock_interval = 256;
+
+    BudgetLimits limits;
+    std::chrono::steady_clock::time_point deadline;
+    int until_clock_check = 0;
+    long long conflicts = 0;
+    long long memory_in_use = 0;
+    Status status = within_budget;
+    const std::atomic<bool> *stop_flag = nullptr;
+    const std::atomic<bool> *inherited_stop_flag = nullptr;
+
+    bool stopped() const {
+        if (stop_flag == nullptr) return false;
+        if (stop_flag->load(std::memory_order_relaxed)) return true;
+        return inherited_stop_flag != nullptr && inherited_stop_flag->load(std::memory_order_relaxed);
+    }
+
+    bool time_is_up() {
+        if (limits.seconds <= 0 || --until_clock_check > 0) return false;
+        until_clock_check = clock_interval;
+        return std::chrono::steady_clock::now() >= deadline;
+    }
+
+public:
+    SolveBudget() {}
+    explicit SolveBudget(const BudgetLimits &budget_limits) : limits(budget_limits) {
+        auto duration = std::chrono::duration<double>(limits.seconds);
+        deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration);
+    }
+
+    // Watches flag as well as the flag this budget was copied with, if any.
+    // Only the two innermost flags are watched.
+    void set_stop_flag(const std::atomic<bool> *flag) {
+        if (stop_flag != nullptr && stop_flag != flag) inherited_stop_flag = stop_flag;
+        stop_flag = flag;
+    }
+    void charge(long long bytes) { memory_in_use += bytes; }
+    void release(long long bytes) { memory_in_use -= bytes; }
+
+    // Checks time and memory. Returns true once the run should stop.
+    bool exhausted() {
+        if (status != within_budget) return true;
+        if (stopped()) status = cancelled;
+        else if (limits.memory_bytes > 0 && memory_in_use > limits.memory_bytes) status = out_of_memory;
+        else if (time_is_up()) status = out_of_time;
+        return status != within_budget;
+    }
+    // Counts one conflict, then checks all limits.
+    bool conflict() {
+        if (limits.conflicts > 0 && ++conflicts > limits.conflicts && status == within_budget) status = out_of_conflicts;
+        return exhausted();
+    }
+
+    Status state() const { return status; }
+    // The result reported for a run stopped by its budget.
+    const char *outcome() const {
+        switch (status) {
+            case out_of_time: return "TIMEOUT";
+            case out_of_memory: return "MEMOUT";
+            default: return "UNKNOWN";
+        }
+    }
+};
+
+// Charges bytes to a budget for as long as it lives.
+class BudgetCharge {
+private:
+    SolveBudget &budget;
+    long long bytes;
+
+public:
+    BudgetCharge(SolveBudget &charged_budget, long long charged_bytes) : budget(charged_budget), bytes(charged_bytes) {
+        budget.charge(bytes);
+    }
+    BudgetCharge(const BudgetCharge &) = delete;
+    BudgetCharge &operator=(const BudgetCharge &) = delete;
+    ~BudgetCharge() { budget.release(bytes); }
+};
+
+#endif
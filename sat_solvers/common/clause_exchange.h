@@ -0,0 +1,84 @@
+#ifndef SAT_SOLVERS_COMMON_CLAUSE_EXCHANGE_H
+#define SAT_SOLVERS_COMMON_CLAUSE_EXCHANGE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Passes learnt clauses between solver threads without locks. Every thread
+// owns one ring buffer of words that only it writes, as a header of size
+// and LBD followed by the literals, and every other thread reads it with
+// its own cursor. A writer never waits: when a reader falls more than a
+// ring behind, the clauses it missed are lost, which costs nothing but the
+// sharing. The words are relaxed atomics, and the rings work like a
+// seqlock. A writer announces how far it is about to write before
+// touching any word, and a reader that finds this announcement has reached
+// words it just copied throws the copy away.
+class ClauseExchange {
+private:
+    static const uint64_t ring_words = 1 << 16;
+
+    struct alignas(64) Ring {
+        std::atomic<uint64_t> reserved{0};
+        std::atomic<uint64_t> written{0};
+        std::unique_ptr<std::atomic<int>[]> words{new std::atomic<int>[ring_words]};
+    };
+
+    std::vector<std::unique_ptr<Ring>> rings;
+    // cursors[reader][writer] is the next position reader takes from writer.
+    std::vector<std::vector<uint64_t>> cursors;
+    std::vector<std::vector<int>> copies;
+
+public:
+    explicit ClauseExchange(int threads);
+    int threads() const { return rings.size(); }
+    // Shares a clause from thread. Clauses over half a ring are dropped.
+    void publish(int thread, const int *literals, int size, uint32_t lbd);
+    // Calls receive(literals, size, lbd) for every clause the other threads
+    // published since thread last collected. Only thread may call this.
+    template <class Receive> void collect(int thread, Receive receive);
+};
+
+inline ClauseExchange::ClauseExchange(int threads)
+    : cursors(threads, std::vector<uint64_t>(threads, 0)), copies(threads) {
+    for (int i = 0; i < threads; i++) rings.emplace_back(new Ring());
+}
+
+inline void ClauseExchange::publish(int thread, const int *literals, int size, uint32_t lbd) {
+    if (size + 2 > (int)(ring_words / 2)) return;
+    Ring &ring = *rings[thread];
+    uint64_t start = ring.written.load(std::memory_order_relaxed);
+    uint64_t end = start + size + 2;
+    ring.reserved.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ring.words[start % ring_words].store(size, std::memory_order_relaxed);
+    ring.words[(start + 1) % ring_words].store((int)lbd, std::memory_order_relaxed);
+    for (int i = 0; i < size; i++) {
+        ring.words[(start + 2 + i) % ring_words].store(literals[i], std::memory_order_relaxed);
+    }
+    ring.written.store(end, std::memory_order_release);
+}
+
+template <class Receive>
+inline void ClauseExchange::collect(int thread, Receive receive) {
+    std::vector<int> &copy = copies[thread];
+    for (int writer = 0; writer < threads(); writer++) {
+        if (writer == thread) continue;
+        Ring &ring = *rings[writer];
+        uint64_t &cursor = cursors[thread][writer];
+        uint64_t end = ring.written.load(std::memory_order_acquire);
+        uint64_t start = cursor;
+        cursor = end;
+        if (end == start || end - start > ring_words) continue;
+        copy.resize(end - start);
+        for (uint64_t position = start; position < end; position++) {
+            copy[position - start] = ring.words[position % ring_words].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (ring.reserved.load(std::memory_order_relaxed) > start + ring_words) continue;
+        for (size_t i = 0; i < copy.size(); i += 2 + copy[i]) receive(&copy[i + 2], copy[i], (uint32_t)copy[i + 1]);
+    }
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef SAT_SOLVERS_COMMON_COMPONENTS_H
+#define SAT_SOLVERS_COMMON_COMPONENTS_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+#include "dimacs_parser.h"
+
+// Disjoint sets over 0..size-1 with union by size and path halving.
+class UnionFind {
+private:
+    std::vector<int> parent;
+    std::vector<int> set_size;
+
+public:
+    explicit UnionFind(int size) : parent(size), set_size(size, 1) {
+        std::iota(parent.begin(), parent.end(), 0);
+    }
+    int find(int element) {
+        while (parent[element] != element) {
+            parent[element] = parent[parent[element]];
+            element = parent[element];
+        }
+        return element;
+    }
+    void unite(int first, int second) {
+        first = find(first);
+        second = find(second);
+        if (first == second) return;
+        if (set_size[first] < set_size[second]) std::swap(first, second);
+        parent[second] = first;
+        set_size[first] += set_size[second];
+    }
+};
+
+// One variable-disjoint part of a formula. Its variables are renumbered
+// 1..k in order of first use, and variables[i] is the original number of
+// variable i, with variables[0] unused.
+struct FormulaComponent {
+    DimacsFormula formula;
+    std::vector<int> variables = {0};
+};
+
+// Splits a formula into the connected components of its variable-clause
+// graph: two variables are connected when a clause holds both. Components
+// come out smallest first, by literal count. Variables in no clause belong
+// to none, and a formula with an empty clause is kept whole, since that
+// clause alone decides it.
+inline std::vector<FormulaComponent> split_components(const DimacsFormula &formula) {
+    std::vector<FormulaComponent> components;
+    UnionFind sets(formula.variable_count + 1);
+    for (size_t i = 0; i < formula.clause_count(); i++) {
+        if (formula.clause_size(i) == 0) {
+            components.resize(1);
+            components[0].formula = formula;
+            components[0].variables.resize(formula.variable_count + 1);
+            std::iota(components[0].variables.begin(), components[0].variables.end(), 0);
+            return components;
+        }
+        int first = std::abs(*formula.clause_begin(i));
+        for (const int *lit = formula.clause_begin(i) + 1; lit != formula.clause_end(i); lit++) {
+            sets.unite(first, std::abs(*lit));
+        }
+    }
+
+    std::vector<int> component_of(formula.variable_count + 1, -1);
+    std::vector<int> local(formula.variable_count + 1, 0);
+    for (size_t i = 0; i < formula.clause_count(); i++) {
+        int root = sets.find(std::abs(*formula.clause_begin(i)));
+        if (component_of[root] < 0) {
+            component_of[root] = components.size();
+            components.emplace_back();
+        }
+        FormulaComponent &component = components[component_of[root]];
+        for (const int *lit = formula.clause_begin(i); lit != formula.clause_end(i); lit++) {
+            int var = std::abs(*lit);
+            if (local[var] == 0) {
+                local[var] = component.variables.size();
+                component.variables.push_back(var);
+            }
+            component.formula.literals.push_back(*lit > 0 ? local[var] : -local[var]);
+        }
+        component.formula.clause_offsets.push_back(component.formula.literals.size());
+    }
+    for (auto &component : components) {
+        component.formula.variable_count = component.variables.size() - 1;
+        component.formula.declared_clause_count = component.formula.clause_count();
+    }
+    std::stable_sort(components.begin(), components.end(), [](const FormulaComponent &a, const FormulaComponent &b) {
+        return a.formula.literals.size() < b.formula.literals.size();
+    });
+    return components;
+}
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef SAT_SOLVERS_COMMON_DIMACS_PARSER_H
+#define SAT_SOLVERS_COMMON_DIMACS_PARSER_H
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A CNF formula exactly as listed in a DIMACS file. The literals of all
+// clauses are stored back to back in one buffer; clause i spans
+// literals[clause_offsets[i]] up to literals[clause_offsets[i + 1]], so
+// clause_offsets always holds one more entry than there are clauses.
+struct DimacsFormula {
+    int variable_count = 0;
+    int declared_clause_count = 0;
+    std::vector<int> literals;
+    std::vector<size_t> clause_offsets = {0};
+
+    size_t clause_count() const { return clause_offsets.size() - 1; }
+    int clause_size(size_t i) const { return clause_offsets[i + 1] - clause_offsets[i]; }
+    const int *clause_begin(size_t i) const { return literals.data() + clause_offsets[i]; }
+    const int *clause_end(size_t i) const { return literals.data() + clause_offsets[i + 1]; }
+    // True if every clause has a literal made true by model[v] for v in
+    // 1..variable_count.
+    bool satisfied_by(const std::vector<bool> &model) const;
+};
+
+inline bool DimacsFormula::satisfied_by(const std::vector<bool> &model) const {
+    if ((int)model.size() <= variable_count) return false;
+    for (size_t i = 0; i < clause_count(); i++) {
+        bool satisfied = false;
+        for (const int *lit = clause_begin(i); lit != clause_end(i) && !satisfied; lit++) {
+            satisfied = model[*lit > 0 ? *lit : -*lit] == (*lit > 0);
+        }
+        if (!satisfied) return false;
+    }
+    return true;
+}
+
+// Read-only memory mapping of a whole file. An empty file maps to a null
+// pointer with size 0.
+class MappedFile {
+private:
+    const char *mapped_data = nullptr;
+    size_t mapped_size = 0;
+#ifdef _WIN32
+    HANDLE file_handle = INVALID_HANDLE_VALUE;
+    HANDLE mapping_handle = nullptr;
+#endif
+
+public:
+    MappedFile() {}
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string &path);
+    void close();
+    const char *data() const { return mapped_data; }
+    size_t size() const { return mapped_size; }
+};
+
+#ifdef _WIN32
+inline bool MappedFile::open(const std::string &path) {
+    close();
+    file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        close();
+        return false;
+    }
+    mapped_size = static_cast<size_t>(file_size.QuadPart);
+    if (mapped_size == 0) return true;
+    mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr) {
+        close();
+        return false;
+    }
+    mapped_data = static_cast<const char *>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (mapped_data == nullptr) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+inline void MappedFile::close() {
+    if (mapped_data != nullptr) UnmapViewOfFile(mapped_data);
+    if (mapping_handle != nullptr) CloseHandle(mapping_handle);
+    if (file_handle != INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+    mapped_data = nullptr;
+    mapped_size = 0;
+    mapping_handle = nullptr;
+    file_handle = INVALID_HANDLE_VALUE;
+}
+#else
+inline bool MappedFile::open(const std::string &path) {
+    close();
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) return false;
+    struct stat file_stat;
+    if (fstat(descriptor, &file_stat) != 0) {
+        ::close(descriptor);
+        return false;
+    }
+    mapped_size = static_cast<size_t>(file_stat.st_size);
+    if (mapped_size > 0) {
+        void *address = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (address == MAP_FAILED) {
+            ::close(descriptor);
+            mapped_size = 0;
+            return false;
+        }
+        madvise(address, mapped_size, MADV_SEQUENTIAL);
+        mapped_data = static_cast<const char *>(address);
+    }
+    ::close(descriptor);
+    return true;
+}
+
+inline void MappedFile::close() {
+    if (mapped_data != nullptr) munmap(const_cast<char *>(mapped_data), mapped_size);
+    mapped_data = nullptr;
+    mapped_size = 0;
+}
+#endif
+
+// Parses DIMACS CNF text. Comment lines start with 'c', the "p cnf <vars>
+// <clauses>" header is optional, a clause ends at its 0 and may span several
+// lines, and a '%' line (as used by SATLIB) ends the formula. A final clause
+// missing its 0 is still kept. variable_count grows to cover every literal
+// even if the header understates it. Returns false and fills error on
+// malformed input.
+inline bool parse_dimacs(const char *data, size_t size, DimacsFormula &formula, std::string &error) {
+    formula = DimacsFormula();
+    formula.literals.reserve(size / 3);
+    const char *position = data;
+    const char *end = data + size;
+    bool clause_open = false;
+
+    auto skip_line = [&]() {
+        while (position < end && *position != '\n') position++;
+    };
+    auto skip_blanks = [&]() {
+        while (position < end && (*position == ' ' || *position == '\t' || *position == '\r')) position++;
+    };
+    // Reads an optionally signed decimal integer at the current position.
+    auto read_integer = [&](long long &value) {
+        bool negative = false;
+        if (position < end && *position == '-') {
+            negative = true;
+            position++;
+        }
+        if (position == end || *position < '0' || *position > '9') return false;
+        value = 0;
+        while (position < end && *position >= '0' && *position <= '9') {
+            value = value * 10 + (*position - '0');
+            if (value > INT_MAX) return false;
+            position++;
+        }
+        if (negative) value = -value;
+        return true;
+    };
+
+    while (position < end) {
+        char c = *position;
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            position++;
+        } else if (c == 'c') {
+            skip_line();
+        } else if (c == '%') {
+            break;
+        } else if (c == 'p') {
+            position++;
+            skip_blanks();
+            if (end - position < 3 || position[0] != 'c' || position[1] != 'n' || position[2] != 'f') {
+                error = "expected \"p cnf\" header";
+                return false;
+            }
+            position += 3;
+            long long variables, clauses;
+            skip_blanks();
+            bool ok = read_integer(variables);
+            skip_blanks();
+            ok = ok && read_integer(clauses);
+            if (!ok || variables < 0 || clauses < 0) {
+                error = "malformed \"p cnf\" header";
+                return false;
+            }
+            if (variables > formula.variable_count) formula.variable_count = variables;
+            formula.declared_clause_count = clauses;
+            // Every clause takes at least two bytes ("0" and a separator), so
+            // a header claiming more cannot be trusted for the reservation.
+            formula.clause_offsets.reserve(std::min<long long>(clauses, size / 2) + 1);
+            skip_line();
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            long long literal;
+            if (!read_integer(literal)) {
+                error = "malformed literal";
+                return false;
+            }
+            if (literal == 0) {
+                formula.clause_offsets.push_back(formula.literals.size());
+                clause_open = false;
+            } else {
+                int variable = literal > 0 ? literal : -literal;
+                if (variable > formula.variable_count) formula.variable_count = variable;
+                formula.literals.push_back(literal);
+                clause_open = true;
+            }
+        } else {
+            error = std::string("unexpected character '") + c + "'";
+            return false;
+        }
+    }
+    if (clause_open) formula.clause_offsets.push_back(formula.literals.size());
+    return true;
+}
+
+inline bool parse_dimacs_file(const std::string &path, DimacsFormula &formula, std::string &error) {
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    return parse_dimacs(file.data(), file.size(), formula, error);
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef SAT_SOLVERS_COMMON_DRAT_WRITER_H
+#define SAT_SOLVERS_COMMON_DRAT_WRITER_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes a proof in binary DRAT: each step is 'a' (added) or 'd' (deleted),
+// the clause literals, then a 0 byte. A literal l is stored as the number
+// 2|l| + (l < 0) in little-endian groups of 7 bits, where the high bit marks
+// that another group follows.
+//
+// Steps are encoded into an in-memory buffer. A full buffer is handed to a
+// background thread, which writes it to the file while the solver fills the
+// other one, so the solver only waits if the disk falls a whole buffer
+// behind.
+class DratWriter {
+private:
+    static const size_t buffer_size = 1 << 20;
+
+    std::FILE *file = nullptr;
+    std::vector<unsigned char> filling;
+    size_t filled = 0;
+    std::vector<unsigned char> writing;
+    size_t to_write = 0;
+    bool stopping = false;
+    std::mutex lock;
+    std::condition_variable changed;
+    std::thread writer;
+
+    void write_loop();
+    void hand_over();
+    void step(unsigned char kind, const int *clause, int size);
+
+public:
+    DratWriter() {}
+    DratWriter(const DratWriter &) = delete;
+    DratWriter &operator=(const DratWriter &) = delete;
+    ~DratWriter() { close(); }
+
+    bool open(const std::string &path);
+    void add(const int *clause, int size) { step('a', clause, size); }
+    void remove(const int *clause, int size) { step('d', clause, size); }
+    // Writes out everything logged so far and closes the file.
+    void close();
+};
+
+inline bool DratWriter::open(const std::string &path) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+    filling.resize(buffer_size);
+    writing.resize(buffer_size);
+    filled = 0;
+    to_write = 0;
+    stopping = false;
+    writer = std::thread(&DratWriter::write_loop, this);
+    return true;
+}
+
+inline void DratWriter::write_loop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        changed.wait(guard, [this] { return to_write > 0 || stopping; });
+        if (to_write > 0) {
+            size_t size = to_write;
+            guard.unlock();
+            std::fwrite(writing.data(), 1, size, file);
+            guard.lock();
+            to_write = 0;
+            changed.notify_all();
+        } else if (stopping) {
+            return;
+        }
+    }
+}
+
+// Swaps the filled buffer with the one being written, once that is done.
+inline void DratWriter::hand_over() {
+    std::unique_lock<std::mutex> guard(lock);
+    changed.wait(guard, [this] { return to_write == 0; });
+    filling.swap(writing);
+    to_write = filled;
+    filled = 0;
+    if (filling.size() < writing.size()) filling.resize(writing.size());
+    changed.notify_all();
+}
+
+inline void DratWriter::step(unsigned char kind, const int *clause, int size) {
+    if (file == nullptr) return;
+    // A literal takes at most 5 bytes, plus the kind and the final 0.
+    size_t needed = 2 + 5 * (size_t)size;
+    if (filled + needed > filling.size()) {
+        hand_over();
+        if (needed > filling.size()) filling.resize(needed);
+    }
+    unsigned char *out = filling.data() + filled;
+    *out++ = kind;
+    for (int i = 0; i < size; i++) {
+        unsigned int encoded = 2u * (clause[i] > 0 ? clause[i] : -clause[i]) + (clause[i] < 0);
+        while (encoded > 127) {
+            *out++ = (unsigned char)(encoded & 127) | 128;
+            encoded >>= 7;
+        }
+        *out++ = (unsigned char)encoded;
+    }
+    *out++ = 0;
+    filled = out - filling.data();
+}
+
+inline void DratWriter::close() {
+    if (file == nullptr) return;
+    if (filled > 0) hand_over();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    changed.notify_all();
+    writer.join();
+    std::fclose(file);
+    file = nullptr;
+}
+
+#endif
@@ -0,0 +1,500 @@
+#ifndef SAT_SOLVERS_COMMON_PREPROCESSOR_H
+#define SAT_SOLVERS_COMMON_PREPROCESSOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "dimacs_parser.h"
+#include "two_sat.h"
+
+// Clauses the preprocessor removed that a model of the original formula
+// must still satisfy, each stored with one of its literals as the witness.
+// extend() walks the entries newest first and sets the witness true
+// whenever its clause is false, which turns a model of the simplified
+// formula into a model of the original one.
+class ModelReconstruction {
+private:
+    std::vector<int> witnesses;
+    std::vector<int> literals;
+    std::vector<size_t> offsets = {0};
+
+public:
+    void push(int witness, const std::vector<int> &clause);
+    // model[v] must exist for v in 1..variable_count.
+    void extend(std::vector<bool> &model) const;
+};
+
+inline void ModelReconstruction::push(int witness, const std::vector<int> &clause) {
+    witnesses.push_back(witness);
+    literals.insert(literals.end(), clause.begin(), clause.end());
+    offsets.push_back(literals.size());
+}
+
+inline void ModelReconstruction::extend(std::vector<bool> &model) const {
+    for (size_t i = witnesses.size(); i-- > 0;) {
+        bool satisfied = false;
+        for (size_t j = offsets[i]; j < offsets[i + 1] && !satisfied; j++) {
+            satisfied = model[std::abs(literals[j])] == (literals[j] > 0);
+        }
+        if (!satisfied) model[std::abs(witnesses[i])] = witnesses[i] > 0;
+    }
+}
+
+// Which simplifications run. Failed literal probing stops after
+// probe_budget clause visits. A variable is only eliminated if that does not
+// increase the clause count and no resolvent has more than
+// max_resolvent_size literals.
+struct PreprocessOptions {
+    bool subsumption = true;
+    bool probing = true;
+    bool equivalences = true;
+    bool elimination = true;
+    long long probe_budget = 10000000;
+    size_t max_resolvent_size = 16;
+};
+
+// Simplifies a formula while keeping it equisatisfiable, in this order:
+//   - literals are sorted and deduplicated, tautologies and duplicate
+//     clauses dropped, and unit clauses propagated;
+//   - subsumed clauses are removed, and self-subsuming resolution removes
+//     a literal l from D when some C holds -l and C \ {-l} is a subset of D;
+//   - failed literal probing: if propagating l alone gives a conflict, -l
+//     is a unit, and a literal implied by both v and -v is a unit too;
+//   - literals in one strongly connected component of the binary clause
+//     implication graph are equivalent and replaced by a representative;
+//   - bounded variable elimination replaces the clauses of a variable by
+//     their resolvents when that does not grow the formula.
+// The clause store works like the DP solver's: sorted literal vectors with
+// per-literal occurrence lists that are cleaned lazily. Variables keep their
+// numbers; fixed and removed ones simply no longer occur.
+class Preprocessor {
+private:
+    PreprocessOptions options;
+    int variable_count;
+    std::vector<std::vector<int>> clauses;
+    std::vector<char> removed;
+    std::vector<uint64_t> signatures;
+    std::vector<std::vector<int>> occurrences;
+    // 1 true, 0 false, -1 unassigned, for fixed and probed values.
+    std::vector<signed char> value;
+    std::vector<signed char> probe_value;
+    std::vector<char> eliminated;
+    std::vector<int> pending_units;
+    // Clauses added since subsumption last looked at them.
+    std::vector<int> touched;
+    bool unsatisfiable = false;
+    ModelReconstruction &reconstruction;
+
+    static int occurrence_index(int lit) { return 2 * std::abs(lit) + (lit < 0); }
+    static uint64_t signature(const std::vector<int> &clause);
+    static int literal_value(const std::vector<signed char> &values, int lit);
+    const std::vector<int> &live_occurrences(int lit);
+    void add_clause(std::vector<int> clause);
+    void remove_clause(int c);
+    void assign(int lit);
+    bool propagate();
+    void subsume(int c);
+    void run_subsumption();
+    bool probe(int lit, std::vector<int> &implied, long long &budget);
+    void run_probing();
+    void substitute_equivalences();
+    static bool resolve(const std::vector<int> &pos, const std::vector<int> &neg, int var,
+                        std::vector<int> &resolvent);
+    bool try_eliminate(int var);
+    void run_elimination();
+
+public:
+    Preprocessor(const DimacsFormula &formula, ModelReconstruction &model_reconstruction,
+                 const PreprocessOptions &preprocess_options = PreprocessOptions());
+    void run();
+    // The simplified formula; a single empty clause if it was refuted.
+    void write(DimacsFormula &formula) const;
+};
+
+inline Preprocessor::Preprocessor(const DimacsFormula &formula, ModelReconstruction &model_reconstruction,
+                                  const PreprocessOptions &preprocess_options)
+    : options(preprocess_options), variable_count(formula.variable_count),
+      occurrences(2 * formula.variable_count + 2), value(formula.variable_count + 1, -1),
+      probe_value(formula.variable_count + 1, -1), eliminated(formula.variable_count + 1, 0),
+      reconstruction(model_reconstruction) {
+    std::vector<std::vector<int>> sorted;
+    sorted.reserve(formula.clause_count());
+    for (size_t i = 0; i < formula.clause_count(); i++) {
+        std::vector<int> clause(formula.clause_begin(i), formula.clause_end(i));
+        std::sort(clause.begin(), clause.end());
+        clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+        sorted.push_back(clause);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    for (auto &clause : sorted) add_clause(clause);
+}
+
+// One bit per variable modulo 64. A clause can only subsume, or strengthen,
+// another whose bits are a superset of its own.
+inline uint64_t Preprocessor::signature(const std::vector<int> &clause) {
+    uint64_t bits = 0;
+    for (int lit : clause) bits |= uint64_t(1) << (std::abs(lit) & 63);
+    return bits;
+}
+
+inline int Preprocessor::literal_value(const std::vector<signed char> &values, int lit) {
+    int v = values[std::abs(lit)];
+    return (v == -1) ? -1 : (lit > 0 ? v : 1 - v);
+}
+
+inline const std::vector<int> &Preprocessor::live_occurrences(int lit) {
+    std::vector<int> &list = occurrences[occurrence_index(lit)];
+    list.erase(std::remove_if(list.begin(), list.end(), [this](int c) { return removed[c]; }), list.end());
+    return list;
+}
+
+// Stores a clause after dropping false literals. Satisfied clauses and
+// tautologies are ignored, and a unit is assigned instead of stored.
+inline void Preprocessor::add_clause(std::vector<int> clause) {
+    std::sort(clause.begin(), clause.end());
+    clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+    size_t kept = 0;
+    for (int lit : clause) {
+        if (std::binary_search(clause.begin(), clause.end(), -lit)) return;
+        int lit_value = literal_value(value, lit);
+        if (lit_value == 1) return;
+        if (lit_value == -1) clause[kept++] = lit;
+    }
+    clause.resize(kept);
+    if (clause.empty()) {
+        unsatisfiable = true;
+        return;
+    }
+    if (clause.size() == 1) {
+        assign(clause[0]);
+        return;
+    }
+
+    int c = clauses.size();
+    for (int lit : clause) occurrences[occurrence_index(lit)].push_back(c);
+    signatures.push_back(signature(clause));
+    clauses.push_back(std::move(clause));
+    removed.push_back(0);
+    touched.push_back(c);
+}
+
+inline void Preprocessor::remove_clause(int c) {
+    removed[c] = 1;
+    std::vector<int>().swap(clauses[c]);
+}
+
+inline void Preprocessor::assign(int lit) {
+    int lit_value = literal_value(value, lit);
+    if (lit_value == 0) unsatisfiable = true;
+    if (lit_value != -1) return;
+    value[std::abs(lit)] = lit > 0;
+    reconstruction.push(lit, {lit});
+    pending_units.push_back(lit);
+}
+
+// Removes the clauses satisfied by pending units and strips the falsified
+// literals from the rest. Returns false once the formula is refuted.
+inline bool Preprocessor::propagate() {
+    while (!pending_units.empty() && !unsatisfiable) {
+        int lit = pending_units.back();
+        pending_units.pop_back();
+        std::vector<int> satisfied = live_occurrences(lit);
+        for (int c : satisfied) remove_clause(c);
+        std::vector<int> falsified = live_occurrences(-lit);
+        for (int c : falsified) {
+            std::vector<int> rest;
+            for (int l : clauses[c])
+                if (l != -lit) rest.push_back(l);
+            remove_clause(c);
+            add_clause(rest);
+        }
+    }
+    return !unsatisfiable;
+}
+
+// Uses clause c to subsume or strengthen others. Any such clause contains
+// every variable of c, so the variable with the fewest occurrences in
+// either sign lists them all.
+inline void Preprocessor::subsume(int c) {
+    if (removed[c]) return;
+    std::vector<int> clause = clauses[c];
+    uint64_t clause_signature = signatures[c];
+    int best = clause[0];
+    size_t best_count = live_occurrences(best).size() + live_occurrences(-best).size();
+    for (int lit : clause) {
+        size_t count = live_occurrences(lit).size() + live_occurrences(-lit).size();
+        if (count < best_count) {
+            best = lit;
+            best_count = count;
+        }
+    }
+    std::vector<int> candidates = live_occurrences(best);
+    const std::vector<int> &negated = live_occurrences(-best);
+    candidates.insert(candidates.end(), negated.begin(), negated.end());
+
+    for (int d : candidates) {
+        if (d == c || removed[d] || clauses[d].size() < clause.size()) continue;
+        if ((clause_signature & ~signatures[d]) != 0) continue;
+        const std::vector<int> &other = clauses[d];
+        int flipped = 0;
+        bool matches = true;
+        for (int lit : clause) {
+            if (std::binary_search(other.begin(), other.end(), lit)) continue;
+            if (flipped == 0 && std::binary_search(other.begin(), other.end(), -lit)) {
+                flipped = -lit;
+                continue;
+            }
+            matches = false;
+            break;
+        }
+        if (!matches) continue;
+        if (flipped == 0) {
+            remove_clause(d);
+            continue;
+        }
+        std::vector<int> strengthened;
+        for (int lit : other)
+            if (lit != flipped) strengthened.push_back(lit);
+        remove_clause(d);
+        add_clause(strengthened);
+    }
+}
+
+inline void Preprocessor::run_subsumption() {
+    std::vector<int> batch;
+    while (!touched.empty() && propagate()) {
+        batch.swap(touched);
+        touched.clear();
+        std::sort(batch.begin(), batch.end(), [this](int a, int b) { return clauses[a].size() < clauses[b].size(); });
+        for (int c : batch) subsume(c);
+    }
+    propagate();
+}
+
+// Propagates lit on its own and collects every literal it implies, lit
+// included. Returns false on a conflict.
+inline bool Preprocessor::probe(int lit, std::vector<int> &implied, long long &budget) {
+    implied.assign(1, lit);
+    probe_value[std::abs(lit)] = lit > 0;
+    bool conflict = false;
+    for (size_t i = 0; i < implied.size() && !conflict; i++) {
+        for (int c : live_occurrences(-implied[i])) {
+            budget--;
+            int unassigned = 0, last = 0;
+            bool satisfied = false;
+            for (int l : clauses[c]) {
+                int l_value = literal_value(probe_value, l);
+                if (l_value == 1) {
+                    satisfied = true;
+                    break;
+                }
+                if (l_value == -1) {
+                    unassigned++;
+                    last = l;
+                }
+            }
+            if (satisfied || unassigned > 1) continue;
+            if (unassigned == 0) {
+                conflict = true;
+                break;
+            }
+            probe_value[std::abs(last)] = last > 0;
+            implied.push_back(last);
+        }
+    }
+    for (int l : implied) probe_value[std::abs(l)] = -1;
+    return !conflict;
+}
+
+inline void Preprocessor::run_probing() {
+    long long budget = options.probe_budget;
+    std::vector<int> positive, negative;
+    for (int v = 1; v <= variable_count && budget > 0 && !unsatisfiable; v++) {
+        if (value[v] != -1 || eliminated[v]) continue;
+        if (live_occurrences(v).empty() && live_occurrences(-v).empty()) continue;
+        if (!probe(v, positive, budget)) {
+            assign(-v);
+            propagate();
+            continue;
+        }
+        if (!probe(-v, negative, budget)) {
+            assign(v);
+            propagate();
+            continue;
+        }
+        std::sort(positive.begin(), positive.end());
+        for (int lit : negative)
+            if (std::binary_search(positive.begin(), positive.end(), lit)) assign(lit);
+        propagate();
+    }
+}
+
+// Finds the strongly connected components of the implication graph of the
+// binary clauses. Every literal in a component is equivalent to the one
+// with the lowest variable, which replaces it in all clauses.
+inline void Preprocessor::substitute_equivalences() {
+    if (unsatisfiable) return;
+    int node_count = 2 * variable_count;
+    auto node = [](int lit) { return lit > 0 ? 2 * (lit - 1) : 2 * (-lit - 1) + 1; };
+    std::vector<int> edge_from, edge_to;
+    for (size_t c = 0; c < clauses.size(); c++) {
+        if (removed[c] || clauses[c].size() != 2) continue;
+        int a = clauses[c][0], b = clauses[c][1];
+        edge_from.push_back(node(-a));
+        edge_to.push_back(node(b));
+        edge_from.push_back(node(-b));
+        edge_to.push_back(node(a));
+    }
+    if (edge_from.empty()) return;
+    std::vector<int> first_edge(node_count + 1, 0), targets(edge_to.size());
+    for (int from : edge_from) first_edge[from + 1]++;
+    for (int i = 0; i < node_count; i++) first_edge[i + 1] += first_edge[i];
+    std::vector<int> fill(first_edge.begin(), first_edge.end() - 1);
+    for (size_t i = 0; i < edge_from.size(); i++) targets[fill[edge_from[i]]++] = edge_to[i];
+
+    std::vector<int> component;
+    int component_count = strongly_connected_components(first_edge, targets, component);
+    // Components of v and -v mirror each other, so the first variable met
+    // in either one represents both, with opposite signs.
+    std::vector<int> representative(component_count, 0);
+    for (int v = 1; v <= variable_count; v++) {
+        if (value[v] != -1 || eliminated[v]) continue;
+        int positive = component[node(v)], negative = component[node(-v)];
+        if (positive == negative) {
+            unsatisfiable = true;
+            return;
+        }
+        if (representative[positive] == 0) {
+            representative[positive] = v;
+            representative[negative] = -v;
+        }
+    }
+
+    for (int v = 1; v <= variable_count; v++) {
+        if (value[v] != -1 || eliminated[v]) continue;
+        int r = representative[component[node(v)]];
+        if (r == v) continue;
+        eliminated[v] = 1;
+        reconstruction.push(v, {v, -r});
+        reconstruction.push(-v, {-v, r});
+        for (int lit : {v, -v}) {
+            std::vector<int> affected = live_occurrences(lit);
+            for (int c : affected) {
+                std::vector<int> substituted = clauses[c];
+                for (int &l : substituted) {
+                    if (l == v) l = r;
+                    else if (l == -v) l = -r;
+                }
+                remove_clause(c);
+                add_clause(substituted);
+            }
+        }
+    }
+    propagate();
+}
+
+// Merges two sorted clauses without var and -var. Returns false for a
+// tautological resolvent.
+inline bool Preprocessor::resolve(const std::vector<int> &pos, const std::vector<int> &neg, int var,
+                                  std::vector<int> &resolvent) {
+    resolvent.clear();
+    size_t i = 0, j = 0;
+    while (i < pos.size() || j < neg.size()) {
+        int lit;
+        if (j == neg.size() || (i < pos.size() && pos[i] < neg[j])) lit = pos[i++];
+        else if (i == pos.size() || neg[j] < pos[i]) lit = neg[j++];
+        else { lit = pos[i++]; j++; }
+        if (lit == var || lit == -var) continue;
+        if (std::binary_search(pos.begin(), pos.end(), -lit) || std::binary_search(neg.begin(), neg.end(), -lit))
+            return false;
+        resolvent.push_back(lit);
+    }
+    return true;
+}
+
+// Eliminates var if its non tautological resolvents are no more than the
+// clauses they replace. The replaced clauses go on the reconstruction stack
+// with var as their witness.
+inline bool Preprocessor::try_eliminate(int var) {
+    std::vector<int> pos = live_occurrences(var), neg = live_occurrences(-var);
+    if (pos.empty() && neg.empty()) return false;
+    size_t limit = pos.size() + neg.size();
+    std::vector<std::vector<int>> resolvents;
+    std::vector<int> resolvent;
+    for (int c1 : pos) {
+        for (int c2 : neg) {
+            if (!resolve(clauses[c1], clauses[c2], var, resolvent)) continue;
+            if (resolvents.size() == limit || resolvent.size() > options.max_resolvent_size) return false;
+            resolvents.push_back(resolvent);
+        }
+    }
+
+    eliminated[var] = 1;
+    for (int c : pos) reconstruction.push(var, clauses[c]);
+    for (int c : neg) reconstruction.push(-var, clauses[c]);
+    for (int c : pos) remove_clause(c);
+    for (int c : neg) remove_clause(c);
+    for (auto &r : resolvents) add_clause(r);
+    return true;
+}
+
+// Tries the variables in order of |pos| * |neg|, cheapest first, and goes
+// round again while that keeps eliminating something.
+inline void Preprocessor::run_elimination() {
+    bool progress = true;
+    for (int round = 0; round < 3 && progress && !unsatisfiable; round++) {
+        progress = false;
+        std::vector<std::pair<long long, int>> order;
+        for (int v = 1; v <= variable_count; v++) {
+            if (value[v] != -1 || eliminated[v]) continue;
+            order.push_back({(long long)live_occurrences(v).size() * live_occurrences(-v).size(), v});
+        }
+        std::sort(order.begin(), order.end());
+        for (const auto &entry : order) {
+            int v = entry.second;
+            if (value[v] != -1 || eliminated[v]) continue;
+            if (try_eliminate(v)) progress = true;
+            if (!propagate()) return;
+        }
+    }
+}
+
+inline void Preprocessor::run() {
+    if (!propagate()) return;
+    if (options.subsumption) run_subsumption();
+    if (options.probing) run_probing();
+    if (options.equivalences) substitute_equivalences();
+    if (options.subsumption) run_subsumption();
+    if (options.elimination) run_elimination();
+    if (options.subsumption) run_subsumption();
+    propagate();
+}
+
+inline void Preprocessor::write(DimacsFormula &formula) const {
+    formula = DimacsFormula();
+    formula.variable_count = variable_count;
+    if (unsatisfiable) {
+        formula.clause_offsets.push_back(0);
+    } else {
+        for (size_t c = 0; c < clauses.size(); c++) {
+            if (removed[c]) continue;
+            formula.literals.insert(formula.literals.end(), clauses[c].begin(), clauses[c].end());
+            formula.clause_offsets.push_back(formula.literals.size());
+        }
+    }
+    formula.declared_clause_count = formula.clause_count();
+}
+
+// Replaces formula by its simplified form and records in reconstruction
+// how to extend a model of the result to the original variables.
+inline void preprocess(DimacsFormula &formula, ModelReconstruction &reconstruction,
+                       const PreprocessOptions &options = PreprocessOptions()) {
+    Preprocessor preprocessor(formula, reconstruction, options);
+    preprocessor.run();
+    preprocessor.write(formula);
+}
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef SAT_SOLVERS_COMMON_STATISTICS_H
+#define SAT_SOLVERS_COMMON_STATISTICS_H
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Per-instance counters and phase timers. They are only collected when the
+// solvers are compiled with -DSAT_SOLVER_STATISTICS. Otherwise SAT_STAT and
+// SAT_PHASE_TIMER expand to nothing, so the hot paths carry no extra work,
+// and the batch driver prints no statistics.
+struct SolverStatistics {
+    uint64_t decisions = 0;
+    uint64_t propagations = 0;
+    uint64_t conflicts = 0;
+    uint64_t restarts = 0;
+    uint64_t learnt_clauses = 0;
+    uint64_t learnt_literals = 0;
+    uint64_t learnt_lbd = 0;
+    uint64_t resolvents = 0;
+    uint64_t flips = 0;
+    // Learnt clauses passed to and taken from other threads.
+    uint64_t exported_clauses = 0;
+    uint64_t imported_clauses = 0;
+    uint64_t cubes = 0;
+    uint64_t peak_clauses = 0;
+    double parse_ms = 0;
+    double preprocess_ms = 0;
+    double propagate_ms = 0;
+    double analyze_ms = 0;
+    double decide_ms = 0;
+    // Time spent resolving, for the DP and resolution solvers.
+    double resolve_ms = 0;
+    long long peak_rss_kb = 0;
+
+    void note_clause_count(uint64_t count) {
+        if (count > peak_clauses) peak_clauses = count;
+    }
+    // Adds the counters and timers of another run, such as a worker thread
+    // of this one.
+    void merge(const SolverStatistics &other);
+    // Counters and timers that were used, as "name=value" pairs.
+    std::string summary() const;
+};
+
+#ifdef SAT_SOLVER_STATISTICS
+#define SAT_STAT(statement) \
+    do {                    \
+        statement;          \
+    } while (0)
+#define SAT_PHASE_TIMER(total) PhaseTimer phase_timer(total)
+#else
+#define SAT_STAT(statement) \
+    do {                    \
+    } while (0)
+#define SAT_PHASE_TIMER(total) \
+    do {                       \
+    } while (0)
+#endif
+
+// Adds the time until the end of its scope to total, in milliseconds.
+class PhaseTimer {
+private:
+    double &total;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit PhaseTimer(double &phase_total) : total(phase_total), start(std::chrono::steady_clock::now()) {}
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+    ~PhaseTimer() { total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); }
+};
+
+// Peak resident set size of the whole process so far, in KiB. With several
+// worker threads it covers every instance solved up to now, not just one.
+inline long long peak_rss_kb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return (long long)(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+inline void SolverStatistics::merge(const SolverStatistics &other) {
+    decisions += other.decisions;
+    propagations += other.propagations;
+    conflicts += other.conflicts;
+    restarts += other.restarts;
+    learnt_clauses += other.learnt_clauses;
+    learnt_literals += other.learnt_literals;
+    learnt_lbd += other.learnt_lbd;
+    resolvents += other.resolvents;
+    flips += other.flips;
+    exported_clauses += other.exported_clauses;
+    imported_clauses += other.imported_clauses;
+    cubes += other.cubes;
+    note_clause_count(other.peak_clauses);
+    parse_ms += other.parse_ms;
+    preprocess_ms += other.preprocess_ms;
+    propagate_ms += other.propagate_ms;
+    analyze_ms += other.analyze_ms;
+    decide_ms += other.decide_ms;
+    resolve_ms += other.resolve_ms;
+    if (other.peak_rss_kb > peak_rss_kb) peak_rss_kb = other.peak_rss_kb;
+}
+
+inline std::string SolverStatistics::summary() const {
+    std::ostringstream out;
+    auto count = [&](const char *name, uint64_t value) {
+        if (value > 0) out << ' ' << name << '=' << value;
+    };
+    auto time = [&](const char *name, double value) {
+        if (value > 0) out << ' ' << name << '=' << value << "ms";
+    };
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    count("decisions", decisions);
+    count("propagations", propagations);
+    count("conflicts", conflicts);
+    count("restarts", restarts);
+    count("learnts", learnt_clauses);
+    if (learnt_clauses > 0) {
+        out.precision(2);
+        out << " avg_learnt_size=" << (double)learnt_literals / learnt_clauses;
+        out << " avg_lbd=" << (double)learnt_lbd / learnt_clauses;
+        out.precision(3);
+    }
+    count("resolvents", resolvents);
+    count("flips", flips);
+    count("exported", exported_clauses);
+    count("imported", imported_clauses);
+    count("cubes", cubes);
+    count("peak_clauses", peak_clauses);
+    time("parse", parse_ms);
+    time("preprocess", preprocess_ms);
+    time("propagate", propagate_ms);
+    time("analyze", analyze_ms);
+    time("decide", decide_ms);
+    time("resolve", resolve_ms);
+    if (peak_rss_kb > 0) out << " peak_rss=" << peak_rss_kb << "KiB";
+    std::string text = out.str();
+    return text.empty() ? text : text.substr(1);
+}
+
+#endif
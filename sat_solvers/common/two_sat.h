@@ -0,0 +1,107 @@
+#ifndef SAT_SOLVERS_COMMON_TWO_SAT_H
+#define SAT_SOLVERS_COMMON_TWO_SAT_H
+
+#include <algorithm>
+#include <vector>
+
+#include "dimacs_parser.h"
+
+// True if no clause has more than two literals, so the formula can be
+// decided by solve_two_sat in linear time.
+inline bool is_two_sat(const DimacsFormula &formula) {
+    for (size_t i = 0; i < formula.clause_count(); i++) {
+        if (formula.clause_size(i) > 2) return false;
+    }
+    return true;
+}
+
+// Strongly connected components of a graph in compressed adjacency form:
+// the edges of node n lead to targets[first_edge[n]] up to
+// targets[first_edge[n + 1]]. Uses an iterative Tarjan pass, so components
+// are numbered in reverse topological order. Returns the component count.
+inline int strongly_connected_components(const std::vector<int> &first_edge, const std::vector<int> &targets,
+                                         std::vector<int> &component) {
+    int node_count = first_edge.size() - 1;
+    component.assign(node_count, -1);
+    std::vector<int> order(node_count, -1), low(node_count, 0);
+    std::vector<int> next_edge(node_count, 0), scc_stack, call_stack;
+    int visited = 0, component_count = 0;
+    for (int root = 0; root < node_count; root++) {
+        if (order[root] != -1) continue;
+        call_stack.push_back(root);
+        order[root] = low[root] = visited++;
+        next_edge[root] = first_edge[root];
+        scc_stack.push_back(root);
+        while (!call_stack.empty()) {
+            int current = call_stack.back();
+            if (next_edge[current] < first_edge[current + 1]) {
+                int target = targets[next_edge[current]++];
+                if (order[target] == -1) {
+                    order[target] = low[target] = visited++;
+                    next_edge[target] = first_edge[target];
+                    scc_stack.push_back(target);
+                    call_stack.push_back(target);
+                } else if (component[target] == -1) {
+                    low[current] = std::min(low[current], order[target]);
+                }
+                continue;
+            }
+            call_stack.pop_back();
+            if (!call_stack.empty()) low[call_stack.back()] = std::min(low[call_stack.back()], low[current]);
+            if (low[current] == order[current]) {
+                int member;
+                do {
+                    member = scc_stack.back();
+                    scc_stack.pop_back();
+                    component[member] = component_count;
+                } while (member != current);
+                component_count++;
+            }
+        }
+    }
+    return component_count;
+}
+
+// Decides a formula with at most two literals per clause. Each clause (a b)
+// adds the implications -a -> b and -b -> a (a unit clause (a) adds -a -> a),
+// and the formula is unsatisfiable exactly when some x and -x share a
+// strongly connected component. Components come in reverse topological
+// order, so setting x true when its component comes before -x's gives a
+// model. model[v] is filled for v in 1..variable_count.
+inline bool solve_two_sat(const DimacsFormula &formula, std::vector<bool> &model) {
+    int node_count = 2 * formula.variable_count;
+    auto node = [](int literal) { return literal > 0 ? 2 * (literal - 1) : 2 * (-literal - 1) + 1; };
+
+    // Implication graph in compressed adjacency form.
+    std::vector<int> edge_from, edge_to;
+    for (size_t i = 0; i < formula.clause_count(); i++) {
+        const int *clause = formula.clause_begin(i);
+        int size = formula.clause_size(i);
+        if (size == 0) return false;
+        int a = clause[0], b = (size == 2) ? clause[1] : clause[0];
+        edge_from.push_back(node(-a));
+        edge_to.push_back(node(b));
+        if (a != b) {
+            edge_from.push_back(node(-b));
+            edge_to.push_back(node(a));
+        }
+    }
+    std::vector<int> first_edge(node_count + 1, 0), targets(edge_to.size());
+    for (int from : edge_from) first_edge[from + 1]++;
+    for (int i = 0; i < node_count; i++) first_edge[i + 1] += first_edge[i];
+    std::vector<int> fill(first_edge.begin(), first_edge.end() - 1);
+    for (size_t i = 0; i < edge_from.size(); i++) targets[fill[edge_from[i]]++] = edge_to[i];
+
+    std::vector<int> component;
+    strongly_connected_components(first_edge, targets, component);
+
+    model.assign(formula.variable_count + 1, false);
+    for (int v = 1; v <= formula.variable_count; v++) {
+        int positive = component[node(v)], negative = component[node(-v)];
+        if (positive == negative) return false;
+        model[v] = positive < negative;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef SAT_SOLVERS_COMMON_WORK_STEALING_POOL_H
+#define SAT_SOLVERS_COMMON_WORK_STEALING_POOL_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs a batch of independent tasks on a fixed number of threads. Tasks are
+// dealt out round robin into one deque per worker, in index order. A worker
+// takes tasks from the front of its own deque and, once that is empty,
+// steals from the back of the others. Callers that put their most
+// expensive tasks first therefore get those started first everywhere, and
+// the cheap tail is what gets rebalanced.
+class WorkStealingPool {
+private:
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+
+    int thread_count;
+
+    static bool take_own(WorkerQueue &queue, size_t &task);
+    static bool steal(WorkerQueue &queue, size_t &task);
+
+public:
+    explicit WorkStealingPool(int threads) : thread_count(threads < 1 ? 1 : threads) {}
+    int threads() const { return thread_count; }
+    // Calls task(worker, i) once for every i in [0, task_count) and returns
+    // when all of them have finished. worker is the index of the calling
+    // thread, in [0, threads()). With one thread everything runs inline.
+    void run(size_t task_count, const std::function<void(int, size_t)> &task);
+};
+
+inline bool WorkStealingPool::take_own(WorkerQueue &queue, size_t &task) {
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+inline bool WorkStealingPool::steal(WorkerQueue &queue, size_t &task) {
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+inline void WorkStealingPool::run(size_t task_count, const std::function<void(int, size_t)> &task) {
+    if (thread_count == 1 || task_count <= 1) {
+        for (size_t i = 0; i < task_count; i++) task(0, i);
+        return;
+    }
+    int workers = thread_count;
+    if (task_count < (size_t)workers) workers = task_count;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    for (int i = 0; i < workers; i++) queues.emplace_back(new WorkerQueue());
+    for (size_t i = 0; i < task_count; i++) queues[i % workers]->tasks.push_back(i);
+
+    auto work = [&](int worker) {
+        size_t next;
+        while (true) {
+            if (take_own(*queues[worker], next)) {
+                task(worker, next);
+                continue;
+            }
+            bool stolen = false;
+            for (int offset = 1; offset < workers && !stolen; offset++) {
+                stolen = steal(*queues[(worker + offset) % workers], next);
+            }
+            if (!stolen) return;
+            task(worker, next);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < workers; i++) threads.emplace_back(work, i);
+    work(0);
+    for (auto &thread : threads) thread.join();
+}
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef SAT_SOLVERS_CUBE_AND_CONQUER_CUBE_AND_CONQUER_H
+#define SAT_SOLVERS_CUBE_AND_CONQUER_CUBE_AND_CONQUER_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../cdcl/cdcl_solver.h"
+#include "../common/budget.h"
+#include "../common/dimacs_parser.h"
+#include "../common/statistics.h"
+#include "../common/work_stealing_pool.h"
+#include "../dpll/dpll_solver.h"
+
+struct CubeOptions {
+    // Splitting stops at depth ceil(log2(target_cubes)), so there are at
+    // most this many cubes; refuted branches leave fewer.
+    int target_cubes = 4096;
+    // Variables looked ahead on at each split, preselected by occurrences.
+    int candidates = 32;
+    // Threads solving cubes.
+    int workers = 1;
+    CDCLOptions cdcl;
+};
+
+// Splits a formula into cubes by lookahead over a TrailDPLL. At each node
+// both polarities of the preselected candidates are propagated, and a
+// variable scores the product of the number of clauses each polarity
+// shortens, so the split goes to the variable that reduces the formula
+// most on both sides. A polarity that fails forces the other one into the
+// cube; if both fail, the node is refuted and gives no cube. A node that
+// satisfies every clause ends the cubing with a model.
+class LookaheadCuber {
+private:
+    TrailDPLL &dpll;
+    const CubeOptions &options;
+    SolveBudget &budget;
+    int max_depth = 0;
+    std::vector<int> cube;
+    std::vector<std::vector<int>> cubes;
+    std::vector<bool> model_values;
+    bool found_model = false;
+    bool stopped = false;
+
+    // Clauses shortened by propagating lit, or -1 if it fails.
+    long long probe(int lit);
+    // Fills candidates with the most frequent unassigned variables.
+    void preselect(std::vector<int> &candidates) const;
+    void split(int depth);
+
+public:
+    LookaheadCuber(TrailDPLL &search, const CubeOptions &cube_options, SolveBudget &solve_budget)
+        : dpll(search), options(cube_options), budget(solve_budget) {}
+    // Returns false if the budget ran out before cubing was done.
+    bool run();
+    const std::vector<std::vector<int>> &result() const { return cubes; }
+    bool satisfied() const { return found_model; }
+    const std::vector<bool> &model() const { return model_values; }
+};
+
+inline long long LookaheadCuber::probe(int lit) {
+    long long before = dpll.shortened();
+    bool ok = dpll.push(lit);
+    long long shortened = dpll.shortened() - before;
+    dpll.pop();
+    return ok ? shortened : -1;
+}
+
+inline void LookaheadCuber::preselect(std::vector<int> &candidates) const {
+    candidates.clear();
+    for (int var = 1; var <= dpll.variable_count(); var++) {
+        if (dpll.variable_value(var) == -1 && dpll.occurrence_count(var) + dpll.occurrence_count(-var) > 0)
+            candidates.push_back(var);
+    }
+    auto weight = [&](int var) {
+        return (long long)(dpll.occurrence_count(var) + 1) * (dpll.occurrence_count(-var) + 1);
+    };
+    size_t kept = std::min(candidates.size(), (size_t)std::max(options.candidates, 1));
+    std::partial_sort(candidates.begin(), candidates.begin() + kept, candidates.end(),
+                      [&](int first, int second) { return weight(first) > weight(second); });
+    candidates.resize(kept);
+}
+
+inline void LookaheadCuber::split(int depth) {
+    if (stopped) return;
+    if (budget.exhausted()) {
+        stopped = true;
+        return;
+    }
+    if (dpll.satisfied()) {
+        model_values.assign(dpll.variable_count() + 1, false);
+        for (int var = 1; var <= dpll.variable_count(); var++) model_values[var] = dpll.variable_value(var) == 1;
+        found_model = stopped = true;
+        return;
+    }
+    if (depth >= max_depth) {
+        cubes.push_back(cube);
+        return;
+    }
+
+    size_t cube_size = cube.size();
+    int forced = 0, best = 0;
+    bool refuted = false;
+    std::vector<int> candidates;
+    while (best == 0 && !refuted) {
+        preselect(candidates);
+        if (candidates.empty()) break;
+        long long best_score = -1;
+        for (int var : candidates) {
+            if (dpll.variable_value(var) != -1) continue;
+            long long positive = probe(var), negative = probe(-var);
+            if (positive < 0 && negative < 0) {
+                refuted = true;
+                break;
+            }
+            if (positive < 0 || negative < 0) {
+                // A failed literal: its negation holds under the cube.
+                int implied = positive < 0 ? -var : var;
+                forced++;
+                cube.push_back(implied);
+                if (!dpll.push(implied)) {
+                    refuted = true;
+                    break;
+                }
+                best = 0;
+                best_score = -1;
+                continue;
+            }
+            long long score = (positive + 1) * (negative + 1);
+            if (score > best_score) {
+                best_score = score;
+                best = var;
+            }
+        }
+        if (best != 0 && dpll.variable_value(best) != -1) best = 0;
+    }
+
+    if (!refuted && best == 0) {
+        // Forced literals assigned everything the candidates touched.
+        split(depth);
+    } else if (!refuted) {
+        for (int lit : {best, -best}) {
+            cube.push_back(lit);
+            if (dpll.push(lit)) split(depth + 1);
+            dpll.pop();
+            cube.pop_back();
+            if (stopped) break;
+        }
+    }
+    for (int i = 0; i < forced; i++) dpll.pop();
+    cube.resize(cube_size);
+}
+
+inline bool LookaheadCuber::run() {
+    cubes.clear();
+    max_depth = 0;
+    while ((1LL << max_depth) < options.target_cubes) max_depth++;
+    if (dpll.start()) split(0);
+    return !(stopped && !found_model);
+}
+
+struct CubeAndConquerResult {
+    // "SAT" or "UNSAT", otherwise the budget outcome, e.g. "TIMEOUT".
+    std::string outcome;
+    std::vector<bool> model;
+    // Lookahead statistics plus those of every worker.
+    SolverStatistics statistics;
+};
+
+// Cubes the formula, then solves the cubes as assumptions on a pool of CDCL
+// workers that steal cubes from each other. Each worker keeps one solver
+// for all its cubes, so what it learns on one cube helps with the next. The
+// first satisfiable cube stops the rest, as does a cube refuted without
+// using its assumptions, which refutes the formula. Otherwise the answer
+// is UNSAT once every cube is refuted. The workers get copies of budget.
+inline CubeAndConquerResult cube_and_conquer(const DimacsFormula &formula, const CubeOptions &options,
+                                             SolveBudget &budget) {
+    CubeAndConquerResult result;
+    std::vector<std::vector<int>> cubes;
+    {
+        SAT_PHASE_TIMER(result.statistics.decide_ms);
+        TrailDPLL dpll(load_cnf(formula), formula.variable_count);
+        LookaheadCuber cuber(dpll, options, budget);
+        if (!cuber.run()) {
+            result.outcome = budget.outcome();
+            return result;
+        }
+        if (cuber.satisfied()) {
+            result.outcome = "SAT";
+            result.model = cuber.model();
+            return result;
+        }
+        cubes = cuber.result();
+    }
+    result.statistics.cubes = cubes.size();
+    if (cubes.empty()) {
+        result.outcome = "UNSAT";
+        return result;
+    }
+
+    WorkStealingPool pool(options.workers);
+    std::vector<std::unique_ptr<SATSolverCDCL>> solvers(pool.threads());
+    std::vector<SolveBudget> budgets(pool.threads(), budget);
+    std::vector<SolverStatistics> statistics(pool.threads());
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> refuted(0);
+    std::mutex result_lock;
+    pool.run(cubes.size(), [&](int worker, size_t cube) {
+        if (stop.load(std::memory_order_relaxed)) return;
+        if (!solvers[worker]) {
+            budgets[worker].set_stop_flag(&stop);
+            solvers[worker].reset(new SATSolverCDCL(options.cdcl));
+            solvers[worker]->set_statistics(&statistics[worker]);
+            solvers[worker]->set_budget(&budgets[worker]);
+            solvers[worker]->initialize(formula);
+        }
+        SATSolverCDCL &solver = *solvers[worker];
+        int outcome = solver.solve(cubes[cube]);
+        if (outcome == RetVal::r_unknown || budgets[worker].state() != SolveBudget::within_budget) return;
+        if (outcome == RetVal::r_unsatisfied && !solver.failed_assumptions().empty()) {
+            refuted++;
+            return;
+        }
+        std::lock_guard<std::mutex> guard(result_lock);
+        if (!result.outcome.empty()) return;
+        result.outcome = outcome == RetVal::r_satisfied ? "SAT" : "UNSAT";
+        if (outcome == RetVal::r_satisfied) solver.model(result.model);
+        stop.store(true, std::memory_order_relaxed);
+    });
+
+    for (const auto &worker_statistics : statistics) result.statistics.merge(worker_statistics);
+    if (!result.outcome.empty()) return result;
+    if (refuted == cubes.size()) {
+        result.outcome = "UNSAT";
+        return result;
+    }
+    bool out_of_time = false, out_of_memory = false;
+    for (const auto &worker_budget : budgets) {
+        out_of_time |= worker_budget.state() == SolveBudget::out_of_time;
+        out_of_memory |= worker_budget.state() == SolveBudget::out_of_memory;
+    }
+    result.outcome = out_of_time ? "TIMEOUT" : out_of_memory ? "MEMOUT" : "UNKNOWN";
+    return result;
+}
+
+#endif
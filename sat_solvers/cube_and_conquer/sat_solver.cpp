@@ -0,0 +1,41 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/batch_driver.h"
+#include "../common/dimacs_parser.h"
+#include "cube_and_conquer.h"
+
+int main(int argc, char *argv[]) {
+    CubeOptions options;
+    options.workers = std::max(1u, std::thread::hardware_concurrency());
+    BatchOptions batch;
+    batch.output_path = "results_cube_and_conquer.txt";
+    bool arguments_ok = parse_batch_arguments(argc, argv, batch, [&](const std::string &arg) {
+        if (arg.rfind("--cubes=", 0) == 0) {
+            options.target_cubes = std::stoi(arg.substr(8));
+        } else if (arg.rfind("--candidates=", 0) == 0) {
+            options.candidates = std::stoi(arg.substr(13));
+        } else if (arg.rfind("--parallel=", 0) == 0) {
+            options.workers = std::stoi(arg.substr(11));
+            if (options.workers <= 0) options.workers = std::max(1u, std::thread::hardware_concurrency());
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            options.cdcl.seed = std::stoul(arg.substr(7));
+        } else {
+            return false;
+        }
+        return true;
+    });
+    if (!arguments_ok) return 1;
+    batch.solver_threads = options.workers;
+
+    return run_batch(batch, [&](const DimacsFormula &formula, const SolveContext &context, std::vector<bool> &model) {
+        CubeAndConquerResult result = cube_and_conquer(formula, options, *context.budget);
+        result.statistics.preprocess_ms = context.statistics->preprocess_ms;
+        *context.statistics = result.statistics;
+        model.swap(result.model);
+        return result.outcome;
+    });
+}
@@ -1,159 +1,317 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <set>
-#include <unordered_map>
-#include <unordered_set>
-#include <chrono>
-#include <filesystem>
-#include <iomanip>
+#include <queue>
+#include <cstdint>
 #include <algorithm>
 
-namespace fs = std::filesystem;
+#include "../common/batch_driver.h"
+#include "../common/dimacs_parser.h"
+
 using namespace std;
 
 using Clause = set<int>;
 using CNF = vector<Clause>;
 
-CNF parse_cnf(const string &filename) {
-    ifstream file(filename);
-    string line;
+CNF load_cnf(const DimacsFormula &dimacs) {
     CNF formula;
+    formula.reserve(dimacs.clause_count());
+    for (size_t i = 0; i < dimacs.clause_count(); i++)
+        formula.emplace_back(dimacs.clause_begin(i), dimacs.clause_end(i));
+    return formula;
+}
 
-    while (getline(file, line)) {
-        if (line.empty() || line[0] == 'c') continue;
-        if (line[0] == 'p') continue;
+// Davis-Putnam by variable elimination on one clause store that is edited in
+// place. Clauses are sorted literal vectors; every literal has an occurrence
+// list of the clauses containing it, so finding the clauses to resolve is a
+// lookup rather than a scan. Removed clauses stay in the occurrence lists
+// until the next lookup of that list drops them.
+//
+// Variables are eliminated cheapest first, where the cost is |pos| * |neg|,
+// the number of resolvents elimination can produce. A pure literal has cost
+// 0, so pure literal elimination falls out of the same loop. Unit clauses
+// are propagated before anything else is eliminated.
+//
+// Elimination is bounded: a variable is only eliminated if it adds at most
+// max_growth clauses more than it removes. When even the cheapest variable
+// breaks the bound, the solver splits on it instead and solves both halves
+// as separate formulas. A negative max_growth never splits, which is the
+// original, unbounded procedure.
+class DavisPutnam {
+private:
+    int max_growth;
+    vector<vector<int>> clauses;
+    vector<char> removed;
+    vector<uint64_t> signatures;
+    vector<vector<int>> occurrences;
+    vector<char> eliminated;
+    // (cost, variable) pairs. Costs go stale as clauses come and go, so an
+    // entry is checked against the current cost when it is popped.
+    priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> order;
+    vector<int> units;
+    int live_clause_count;
+    bool empty_clause_found;
+    SolverStatistics *stats;
+    SolveBudget *budget;
+    long long charged_bytes;
 
-        istringstream iss(line);
-        int lit;
-        Clause clause;
-        while (iss >> lit && lit != 0) clause.insert(lit);
-        if (!clause.empty())
-            formula.push_back(clause);
+    static int occurrence_index(int lit) { return 2 * abs(lit) + (lit < 0); }
+    static long long clause_bytes(size_t size) { return sizeof(vector<int>) + sizeof(uint64_t) + 2 * sizeof(int) * size; }
+    static uint64_t signature(const vector<int> &clause);
+    const vector<int> &live_occurrences(int lit);
+    long long cost(int var);
+    bool subsumed_by_existing(const vector<int> &clause, uint64_t clause_signature);
+    void remove_subsumed(const vector<int> &clause, uint64_t clause_signature);
+    void add_clause(const vector<int> &clause);
+    void remove_clause(int c);
+    void assign_unit(int lit);
+    void eliminate(int var);
+    static bool resolve(const vector<int> &pos, const vector<int> &neg, int var, vector<int> &resolvent);
+    long long resolvent_count(int var, long long limit);
+    bool split(int var);
+
+public:
+    DavisPutnam(const CNF &cnf, int num_vars, int max_growth, SolverStatistics *statistics, SolveBudget *solve_budget);
+    ~DavisPutnam() { budget->release(charged_bytes); }
+    bool solve();
+};
+
+DavisPutnam::DavisPutnam(const CNF &cnf, int num_vars, int max_growth, SolverStatistics *statistics,
+                         SolveBudget *solve_budget)
+    : max_growth(max_growth), occurrences(2 * num_vars + 2), eliminated(num_vars + 1, 0), live_clause_count(0),
+      empty_clause_found(false), stats(statistics), budget(solve_budget), charged_bytes(0) {
+    for (const auto &clause : cnf) {
+        vector<int> sorted(clause.begin(), clause.end());
+        bool tautology = false;
+        for (int lit : sorted)
+            if (lit > 0 && clause.count(-lit)) tautology = true;
+        if (!tautology) add_clause(sorted);
     }
-    return formula;
 }
 
-bool contains_empty_clause(const CNF &cnf) {
-    for (const auto &clause : cnf)
-        if (clause.empty()) return true;
-    return false;
+// One bit per variable modulo 64. If a clause subsumes another, its bits are
+// a subset of the other's, which rules out most candidate pairs cheaply.
+uint64_t DavisPutnam::signature(const vector<int> &clause) {
+    uint64_t bits = 0;
+    for (int lit : clause) bits |= uint64_t(1) << (abs(lit) & 63);
+    return bits;
 }
 
-void remove_clauses_with_literal(CNF &cnf, int lit) {
-    cnf.erase(remove_if(cnf.begin(), cnf.end(),
-        [lit](const Clause &c) { return c.count(lit); }), cnf.end());
+const vector<int> &DavisPutnam::live_occurrences(int lit) {
+    vector<int> &list = occurrences[occurrence_index(lit)];
+    list.erase(remove_if(list.begin(), list.end(), [this](int c) { return removed[c]; }), list.end());
+    return list;
 }
 
-void remove_literal_from_clauses(CNF &cnf, int lit) {
-    for (auto &clause : cnf)
-        clause.erase(lit);
+long long DavisPutnam::cost(int var) {
+    return (long long)live_occurrences(var).size() * live_occurrences(-var).size();
 }
 
-bool unit_propagate(CNF &cnf, unordered_set<int> &assignments) {
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        for (auto it = cnf.begin(); it != cnf.end(); ) {
-            if (it->size() == 1) {
-                int unit = *it->begin();
-                assignments.insert(unit);
-                remove_clauses_with_literal(cnf, unit);
-                remove_literal_from_clauses(cnf, -unit);
-                changed = true;
-                it = cnf.begin(); // start over
-            } else {
-                ++it;
-            }
+// Forward subsumption: a clause subsuming the new one contains one of its
+// literals, so only those occurrence lists need checking.
+bool DavisPutnam::subsumed_by_existing(const vector<int> &clause, uint64_t clause_signature) {
+    for (int lit : clause) {
+        for (int c : live_occurrences(lit)) {
+            if ((signatures[c] & ~clause_signature) != 0 || clauses[c].size() > clause.size()) continue;
+            if (includes(clause.begin(), clause.end(), clauses[c].begin(), clauses[c].end())) return true;
         }
     }
-    return !contains_empty_clause(cnf);
-}
-
-void eliminate_pure_literals(CNF &cnf, unordered_set<int> &assignments) {
-    unordered_map<int, int> literal_count;
-    for (const auto &clause : cnf)
-        for (int lit : clause)
-            literal_count[lit]++;
-    for (const auto &[lit, _] : literal_count) {
-        if (!literal_count.count(-lit)) {
-            assignments.insert(lit);
-            remove_clauses_with_literal(cnf, lit);
-        }
+    return false;
+}
+
+// Backward subsumption: every clause the new one subsumes contains all of
+// its literals, so the shortest occurrence list among them holds them all.
+void DavisPutnam::remove_subsumed(const vector<int> &clause, uint64_t clause_signature) {
+    int best = clause[0];
+    for (int lit : clause)
+        if (live_occurrences(lit).size() < live_occurrences(best).size()) best = lit;
+    const vector<int> &candidates = live_occurrences(best);
+    for (size_t i = 0; i < candidates.size(); i++) {
+        int c = candidates[i];
+        if (removed[c] || (clause_signature & ~signatures[c]) != 0 || clauses[c].size() < clause.size()) continue;
+        if (includes(clauses[c].begin(), clauses[c].end(), clause.begin(), clause.end())) remove_clause(c);
     }
 }
 
-CNF resolve_on_variable(const CNF &cnf, int var) {
-    CNF pos_clauses, neg_clauses, rest;
-    for (const auto &clause : cnf) {
-        if (clause.count(var))
-            pos_clauses.push_back(clause);
-        else if (clause.count(-var))
-            neg_clauses.push_back(clause);
-        else
-            rest.push_back(clause);
+// Adds a sorted, duplicate free, non tautological clause unless an existing
+// clause already subsumes it.
+void DavisPutnam::add_clause(const vector<int> &clause) {
+    if (clause.empty()) {
+        empty_clause_found = true;
+        return;
     }
+    uint64_t clause_signature = signature(clause);
+    if (subsumed_by_existing(clause, clause_signature)) return;
+    remove_subsumed(clause, clause_signature);
 
-    CNF resolvents = rest;
-    for (const auto &c1 : pos_clauses) {
-        for (const auto &c2 : neg_clauses) {
-            Clause resolvent;
-            for (int l : c1) if (l != var) resolvent.insert(l);
-            for (int l : c2) if (l != -var) resolvent.insert(l);
-            resolvents.push_back(resolvent);
-        }
+    int c = clauses.size();
+    clauses.push_back(clause);
+    removed.push_back(0);
+    signatures.push_back(clause_signature);
+    live_clause_count++;
+    charged_bytes += clause_bytes(clause.size());
+    budget->charge(clause_bytes(clause.size()));
+    SAT_STAT(stats->note_clause_count(live_clause_count));
+    for (int lit : clause) {
+        occurrences[occurrence_index(lit)].push_back(c);
+        order.push({cost(abs(lit)), abs(lit)});
     }
-    return resolvents;
+    if (clause.size() == 1) units.push_back(clause[0]);
 }
 
-bool davis_putnam(CNF cnf, unordered_set<int> &assignments) {
-    if (contains_empty_clause(cnf)) return false;
-    if (cnf.empty()) return true;
-
-    if (!unit_propagate(cnf, assignments)) return false;
-    eliminate_pure_literals(cnf, assignments);
-    if (cnf.empty()) return true;
-
-    unordered_set<int> vars;
-    for (const auto &clause : cnf)
-        for (int lit : clause)
-            vars.insert(abs(lit));
+void DavisPutnam::remove_clause(int c) {
+    removed[c] = 1;
+    live_clause_count--;
+    charged_bytes -= clause_bytes(clauses[c].size());
+    budget->release(clause_bytes(clauses[c].size()));
+    vector<int>().swap(clauses[c]);
+}
 
-    int var = *vars.begin();  // pick arbitrary variable
-    CNF reduced = resolve_on_variable(cnf, var);
-    return davis_putnam(reduced, assignments);
+// Sets lit true: clauses containing it are satisfied and removed, clauses
+// containing -lit are replaced by their strengthened copy.
+void DavisPutnam::assign_unit(int lit) {
+    SAT_PHASE_TIMER(stats->propagate_ms);
+    SAT_STAT(stats->propagations++);
+    eliminated[abs(lit)] = 1;
+    for (int c : live_occurrences(lit)) remove_clause(c);
+    vector<int> falsified = live_occurrences(-lit);
+    for (int c : falsified) {
+        if (removed[c]) continue;
+        vector<int> strengthened;
+        for (int l : clauses[c])
+            if (l != -lit) strengthened.push_back(l);
+        remove_clause(c);
+        add_clause(strengthened);
+    }
 }
 
-int main() {
-    string folder = "../../cnf_files/samples/";
-    ofstream out("results_davis_putnam.txt");
-    out << fixed << setprecision(3);
+void DavisPutnam::eliminate(int var) {
+    SAT_PHASE_TIMER(stats->resolve_ms);
+    eliminated[var] = 1;
+    vector<int> pos = live_occurrences(var), neg = live_occurrences(-var);
+    vector<vector<int>> pos_clauses, neg_clauses;
+    for (int c : pos) pos_clauses.push_back(clauses[c]);
+    for (int c : neg) neg_clauses.push_back(clauses[c]);
+    for (int c : pos) remove_clause(c);
+    for (int c : neg) remove_clause(c);
 
-    if (!fs::exists(folder) || !fs::is_directory(folder)) {
-        cerr << "Error: directory not found: " << folder << "\n";
-        return 1;
+    vector<int> resolvent;
+    for (const auto &c1 : pos_clauses) {
+        for (const auto &c2 : neg_clauses) {
+            if (resolve(c1, c2, var, resolvent)) {
+                SAT_STAT(stats->resolvents++);
+                add_clause(resolvent);
+            }
+            if (empty_clause_found || budget->exhausted()) return;
+        }
     }
+}
 
-    for (const auto &entry : fs::directory_iterator(folder)) {
-        if (entry.path().extension() == ".cnf") {
-            string file = entry.path().string();
-            string name = entry.path().filename().string();
+// Merges two sorted clauses without var and -var. Returns false for a
+// tautological resolvent, which is dropped.
+bool DavisPutnam::resolve(const vector<int> &pos, const vector<int> &neg, int var, vector<int> &resolvent) {
+    resolvent.clear();
+    size_t i = 0, j = 0;
+    while (i < pos.size() || j < neg.size()) {
+        int lit;
+        if (j == neg.size() || (i < pos.size() && pos[i] < neg[j])) lit = pos[i++];
+        else if (i == pos.size() || neg[j] < pos[i]) lit = neg[j++];
+        else { lit = pos[i++]; j++; }
+        if (lit == var || lit == -var) continue;
+        if (binary_search(pos.begin(), pos.end(), -lit) || binary_search(neg.begin(), neg.end(), -lit)) return false;
+        resolvent.push_back(lit);
+    }
+    return true;
+}
 
-            CNF cnf = parse_cnf(file);
-            unordered_set<int> assignments;
+// Number of non tautological resolvents on var, counting stops past limit.
+long long DavisPutnam::resolvent_count(int var, long long limit) {
+    long long count = 0;
+    vector<int> resolvent;
+    for (int c1 : live_occurrences(var)) {
+        for (int c2 : live_occurrences(-var)) {
+            if (resolve(clauses[c1], clauses[c2], var, resolvent) && ++count > limit) return count;
+        }
+    }
+    return count;
+}
 
-            auto start = chrono::high_resolution_clock::now();
-            bool sat = davis_putnam(cnf, assignments);
-            auto end = chrono::high_resolution_clock::now();
+// Solves the remaining formula once with var true and once with var false.
+bool DavisPutnam::split(int var) {
+    CNF branch;
+    for (size_t c = 0; c < clauses.size(); c++)
+        if (!removed[c]) branch.emplace_back(clauses[c].begin(), clauses[c].end());
+    int num_vars = eliminated.size() - 1;
+    branch.push_back({var});
+    SAT_STAT(stats->decisions++);
+    if (DavisPutnam(branch, num_vars, max_growth, stats, budget).solve()) return true;
+    if (budget->exhausted()) return false;
+    branch.back() = {-var};
+    SAT_STAT(stats->decisions++);
+    return DavisPutnam(branch, num_vars, max_growth, stats, budget).solve();
+}
 
-            double ms = chrono::duration<double, milli>(end - start).count();
-            out << name << ": " << (sat ? "SAT" : "UNSAT") << " in " << ms << " ms\n";
-            cout << name << ": " << (sat ? "SAT" : "UNSAT") << " in " << ms << " ms\n";
+bool DavisPutnam::solve() {
+    while (true) {
+        if (empty_clause_found) {
+            SAT_STAT(stats->conflicts++);
+            budget->conflict();
+            return false;
+        }
+        if (budget->exhausted()) return false;
+        if (!units.empty()) {
+            int unit = units.back();
+            units.pop_back();
+            if (!eliminated[abs(unit)]) assign_unit(unit);
+            continue;
+        }
+        if (live_clause_count == 0) return true;
+        if (order.empty()) {
+            for (int var = 1; var < (int)eliminated.size(); var++)
+                if (!eliminated[var]) order.push({cost(var), var});
+        }
+        auto [queued_cost, var] = order.top();
+        order.pop();
+        if (eliminated[var]) continue;
+        long long current_cost = cost(var);
+        if (current_cost != queued_cost) {
+            order.push({current_cost, var});
+            continue;
         }
+        bool too_many_resolvents = false;
+        if (max_growth >= 0) {
+            SAT_PHASE_TIMER(stats->decide_ms);
+            long long removed_count = live_occurrences(var).size() + live_occurrences(-var).size();
+            too_many_resolvents = current_cost > removed_count + max_growth
+                && resolvent_count(var, removed_count + max_growth) > removed_count + max_growth;
+        }
+        if (too_many_resolvents) return split(var);
+        eliminate(var);
     }
+}
+
+// Returns false without a full search once the budget is exhausted, which
+// the caller tells apart through the budget.
+bool davis_putnam(const CNF &cnf, int num_vars, int max_growth, SolverStatistics &stats, SolveBudget &budget) {
+    DavisPutnam solver(cnf, num_vars, max_growth, &stats, &budget);
+    return solver.solve();
+}
+
+int main(int argc, char *argv[]) {
+    BatchOptions batch;
+    batch.output_path = "results_davis_putnam.txt";
+    int max_growth = 64;
+    bool arguments_ok = parse_batch_arguments(argc, argv, batch, [&](const std::string &arg) {
+        if (arg.rfind("--max-growth=", 0) == 0) max_growth = std::stoi(arg.substr(13));
+        else return false;
+        return true;
+    });
+    if (!arguments_ok) return 1;
 
-    out.close();
-    cout << "Results written to results_davis_putnam.txt\n";
-    return 0;
+    return run_batch(batch, [max_growth](const DimacsFormula &formula, const SolveContext &context, std::vector<bool> &) {
+        CNF cnf = load_cnf(formula);
+        bool sat = davis_putnam(cnf, formula.variable_count, max_growth, *context.statistics,
+                                *context.budget);
+        return string(sat ? "SAT" : "UNSAT");
+    });
 }
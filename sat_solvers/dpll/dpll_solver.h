@@ -0,0 +1,284 @@
+#ifndef SAT_SOLVERS_DPLL_DPLL_SOLVER_H
+#define SAT_SOLVERS_DPLL_DPLL_SOLVER_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "../common/budget.h"
+#include "../common/dimacs_parser.h"
+#include "../common/statistics.h"
+
+using Clause = std::vector<int>;
+using CNF = std::vector<Clause>;
+
+inline CNF load_cnf(const DimacsFormula &dimacs) {
+    CNF formula;
+    formula.reserve(dimacs.clause_count());
+    for (size_t i = 0; i < dimacs.clause_count(); i++) {
+        formula.emplace_back(dimacs.clause_begin(i), dimacs.clause_end(i));
+    }
+    return formula;
+}
+
+// DPLL over one immutable copy of the formula. Assignments live in a flat
+// array and are undone from a trail; instead of rebuilding the formula, each
+// clause keeps a count of its true literals and of its unassigned ones, and
+// each literal keeps the number of unsatisfied clauses it occurs in. Unit
+// clauses and pure literals are found from those counters as they change,
+// and the search keeps an explicit decision stack instead of recursing.
+class TrailDPLL {
+private:
+    struct Decision {
+        size_t trail_size;
+        int literal;
+        bool flipped;
+    };
+
+    int num_vars = 0;
+    std::vector<int> literals;
+    std::vector<size_t> clause_start;
+    std::vector<std::vector<int>> occurrences;
+    std::vector<int> true_count;
+    std::vector<int> unassigned_count;
+    std::vector<int> literal_count;
+    std::vector<signed char> value;
+    std::vector<int> trail;
+    std::vector<int> pending;
+    std::vector<Decision> decisions;
+    SolverStatistics own_statistics;
+    SolverStatistics *stats = &own_statistics;
+    SolveBudget *budget = nullptr;
+    int unsatisfied_clauses = 0;
+    // Clauses that lost a literal while unsatisfied, counted up forever.
+    long long shortened_clauses = 0;
+    bool conflict = false;
+    bool empty_clause = false;
+
+    int index(int lit) const { return 2 * std::abs(lit) + (lit < 0); }
+    int literal_value(int lit) const {
+        int v = value[std::abs(lit)];
+        return (v == -1) ? -1 : (lit > 0 ? v : 1 - v);
+    }
+    void assign(int lit);
+    void unassign(int lit);
+    void undo_to(size_t trail_size);
+    void check_pure(int var);
+    bool propagate();
+    void queue_formula_literals();
+    int pick_literal() const;
+
+public:
+    explicit TrailDPLL(const CNF &cnf, int variable_count);
+    void set_statistics(SolverStatistics *statistics) { stats = statistics; }
+    // Makes solve() give up, returning false, once the budget is exhausted.
+    void set_budget(SolveBudget *solve_budget) { budget = solve_budget; }
+    bool solve();
+    bool model_value(int var) const { return value[var] == 1; }
+
+    // Step-by-step use, as lookahead does it. start() propagates the unit
+    // clauses and pure literals of the formula, push() assigns a literal on
+    // a new level and propagates it, and pop() undoes the last push. Both
+    // return false on a conflict, and a push that failed must still be
+    // popped.
+    bool start();
+    bool push(int lit);
+    void pop();
+    int variable_count() const { return num_vars; }
+    // 1 true, 0 false, -1 unassigned.
+    int variable_value(int var) const { return value[var]; }
+    // Number of unsatisfied clauses lit occurs in.
+    int occurrence_count(int lit) const { return literal_count[index(lit)]; }
+    bool satisfied() const { return unsatisfied_clauses == 0; }
+    long long shortened() const { return shortened_clauses; }
+};
+
+inline TrailDPLL::TrailDPLL(const CNF &cnf, int variable_count) {
+    num_vars = variable_count;
+    for (const auto &clause : cnf)
+        for (int lit : clause) num_vars = std::max(num_vars, std::abs(lit));
+    occurrences.resize(2 * num_vars + 2);
+    literal_count.resize(2 * num_vars + 2, 0);
+    value.resize(num_vars + 1, -1);
+    trail.reserve(num_vars);
+
+    Clause sorted;
+    for (const auto &clause : cnf) {
+        if (clause.empty()) empty_clause = true;
+        sorted = clause;
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        bool tautology = false;
+        for (int lit : sorted)
+            if (std::binary_search(sorted.begin(), sorted.end(), -lit)) tautology = true;
+        if (tautology || sorted.empty()) continue;
+        int clause_index = clause_start.size();
+        clause_start.push_back(literals.size());
+        for (int lit : sorted) {
+            literals.push_back(lit);
+            occurrences[index(lit)].push_back(clause_index);
+            literal_count[index(lit)]++;
+        }
+        true_count.push_back(0);
+        unassigned_count.push_back(sorted.size());
+    }
+    clause_start.push_back(literals.size());
+    unsatisfied_clauses = true_count.size();
+}
+
+// Makes lit true and updates the counters of every clause it occurs in.
+// A clause left with a single unassigned literal queues that literal; one
+// left with none raises the conflict flag. The counters are always updated
+// completely, so unassign() can reverse them exactly.
+inline void TrailDPLL::assign(int lit) {
+    value[std::abs(lit)] = lit > 0 ? 1 : 0;
+    trail.push_back(lit);
+    for (int c : occurrences[index(lit)]) {
+        if (true_count[c]++ > 0) continue;
+        unsatisfied_clauses--;
+        for (size_t i = clause_start[c]; i < clause_start[c + 1]; i++) {
+            int other = literals[i];
+            if (--literal_count[index(other)] == 0) check_pure(std::abs(other));
+        }
+    }
+    for (int c : occurrences[index(-lit)]) {
+        unassigned_count[c]--;
+        if (true_count[c] > 0) continue;
+        shortened_clauses++;
+        if (unassigned_count[c] == 0) {
+            conflict = true;
+        } else if (unassigned_count[c] == 1) {
+            for (size_t i = clause_start[c]; i < clause_start[c + 1]; i++) {
+                if (literal_value(literals[i]) == -1) {
+                    pending.push_back(literals[i]);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+inline void TrailDPLL::unassign(int lit) {
+    for (int c : occurrences[index(-lit)]) unassigned_count[c]++;
+    for (int c : occurrences[index(lit)]) {
+        if (--true_count[c] > 0) continue;
+        unsatisfied_clauses++;
+        for (size_t i = clause_start[c]; i < clause_start[c + 1]; i++) literal_count[index(literals[i])]++;
+    }
+    value[std::abs(lit)] = -1;
+}
+
+inline void TrailDPLL::undo_to(size_t trail_size) {
+    while (trail.size() > trail_size) {
+        unassign(trail.back());
+        trail.pop_back();
+    }
+    pending.clear();
+    conflict = false;
+}
+
+// Queues var's remaining polarity if the other one no longer occurs in any
+// unsatisfied clause.
+inline void TrailDPLL::check_pure(int var) {
+    if (value[var] != -1) return;
+    bool positive = literal_count[index(var)] > 0, negative = literal_count[index(-var)] > 0;
+    if (positive != negative) pending.push_back(positive ? var : -var);
+}
+
+// Assigns queued unit and pure literals until there are none left or a
+// clause is falsified. Returns false on conflict.
+inline bool TrailDPLL::propagate() {
+    SAT_PHASE_TIMER(stats->propagate_ms);
+    while (!pending.empty() && !conflict) {
+        int lit = pending.back();
+        pending.pop_back();
+        int current = literal_value(lit);
+        if (current == 0) {
+            conflict = true;
+        } else if (current == -1) {
+            assign(lit);
+            SAT_STAT(stats->propagations++);
+        }
+    }
+    return !conflict;
+}
+
+inline void TrailDPLL::queue_formula_literals() {
+    for (size_t c = 0; c + 1 < clause_start.size(); c++)
+        if (unassigned_count[c] == 1) pending.push_back(literals[clause_start[c]]);
+    for (int var = 1; var <= num_vars; var++) check_pure(var);
+}
+
+inline bool TrailDPLL::start() {
+    if (empty_clause) return false;
+    queue_formula_literals();
+    return propagate();
+}
+
+inline bool TrailDPLL::push(int lit) {
+    decisions.push_back({trail.size(), lit, false});
+    assign(lit);
+    return propagate();
+}
+
+inline void TrailDPLL::pop() {
+    undo_to(decisions.back().trail_size);
+    decisions.pop_back();
+}
+
+// Branches on the unassigned variable with the most occurrences in
+// unsatisfied clauses, trying its more frequent polarity first.
+inline int TrailDPLL::pick_literal() const {
+    int best = 0, best_count = -1;
+    for (int var = 1; var <= num_vars; var++) {
+        if (value[var] != -1) continue;
+        int positive = literal_count[index(var)], negative = literal_count[index(-var)];
+        if (positive + negative > best_count) {
+            best_count = positive + negative;
+            best = positive >= negative ? var : -var;
+        }
+    }
+    return best;
+}
+
+inline bool TrailDPLL::solve() {
+    if (empty_clause) return false;
+    // The clause store never changes size, so it is charged once: each
+    // literal and its occurrence entry, and each clause's start and counters.
+    if (budget != nullptr)
+        budget->charge(2 * sizeof(int) * literals.size() + (sizeof(size_t) + 2 * sizeof(int)) * true_count.size());
+    queue_formula_literals();
+    SAT_STAT(stats->note_clause_count(true_count.size()));
+
+    while (true) {
+        if (propagate()) {
+            if (unsatisfied_clauses == 0) return true;
+            int lit;
+            {
+                SAT_PHASE_TIMER(stats->decide_ms);
+                lit = pick_literal();
+            }
+            SAT_STAT(stats->decisions++);
+            if (budget != nullptr && budget->exhausted()) return false;
+            decisions.push_back({trail.size(), lit, false});
+            assign(lit);
+            continue;
+        }
+        // Backtracking is this engine's conflict analysis.
+        SAT_STAT(stats->conflicts++);
+        if (budget != nullptr && budget->conflict()) return false;
+        SAT_PHASE_TIMER(stats->analyze_ms);
+        while (!decisions.empty() && decisions.back().flipped) {
+            undo_to(decisions.back().trail_size);
+            decisions.pop_back();
+        }
+        if (decisions.empty()) return false;
+        Decision &decision = decisions.back();
+        undo_to(decision.trail_size);
+        decision.flipped = true;
+        decision.literal = -decision.literal;
+        assign(decision.literal);
+    }
+}
+
+#endif
@@ -1,46 +1,14 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <set>
 #include <map>
-#include <chrono>
-#include <iomanip>
 #include <algorithm>
-#include <filesystem>
 
-namespace fs = std::filesystem;
+#include "../common/batch_driver.h"
+#include "../common/dimacs_parser.h"
+#include "dpll_solver.h"
 
-using Clause = std::vector<int>;
-using CNF = std::vector<Clause>;
 using Assignment = std::map<int, bool>;
-using Clock = std::chrono::high_resolution_clock;
-
-CNF parse_cnf(const std::string& filename, int &num_vars) {
-    std::ifstream file(filename);
-    std::string line;
-    CNF formula;
-
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == 'c') continue;
-        if (line[0] == 'p') {
-            std::istringstream iss(line);
-            std::string tmp;
-            int num_clauses;
-            iss >> tmp >> tmp >> num_vars >> num_clauses;
-        } else {
-            std::istringstream iss(line);
-            int lit;
-            Clause clause;
-            while (iss >> lit && lit != 0) {
-                clause.push_back(lit);
-            }
-            formula.push_back(clause);
-        }
-    }
-
-    return formula;
-}
 
 CNF simplify(const CNF &cnf, int var, bool value) {
     CNF new_cnf;
@@ -67,7 +35,10 @@ CNF simplify(const CNF &cnf, int var, bool value) {
     return new_cnf;
 }
 
-bool unit_propagate(CNF &cnf, Assignment &assignment) {
+bool unit_propagate(CNF &cnf, Assignment &assignment, SolverStatistics &stats) {
+    // stats is only used when SAT_SOLVER_STATISTICS is defined.
+    (void)stats;
+    SAT_PHASE_TIMER(stats.propagate_ms);
     bool changed = true;
     while (changed) {
         changed = false;
@@ -82,6 +53,7 @@ bool unit_propagate(CNF &cnf, Assignment &assignment) {
 
                 assignment[var] = value;
                 cnf = simplify(cnf, var, value);
+                SAT_STAT(stats.propagations++);
                 changed = true;
                 break;
             } else {
@@ -110,36 +82,61 @@ void pure_literal_elimination(CNF &cnf, Assignment &assignment) {
     }
 }
 
-bool dpll(CNF cnf, Assignment &assignment) {
-    if (!unit_propagate(cnf, assignment)) return false;
+long long formula_bytes(const CNF &cnf) {
+    long long bytes = sizeof(CNF) + cnf.capacity() * sizeof(Clause);
+    for (const auto &clause : cnf) bytes += clause.capacity() * sizeof(int);
+    return bytes;
+}
+
+// Returns false without a full search once the budget is exhausted, which
+// the caller tells apart through the budget. Every level of the recursion
+// keeps its own copy of the formula, and each copy is charged to the budget.
+bool dpll(CNF cnf, Assignment &assignment, SolverStatistics &stats, SolveBudget &budget) {
+    BudgetCharge charge(budget, formula_bytes(cnf));
+    if (budget.exhausted()) return false;
+    SAT_STAT(stats.note_clause_count(cnf.size()));
+    if (!unit_propagate(cnf, assignment, stats)) {
+        SAT_STAT(stats.conflicts++);
+        budget.conflict();
+        return false;
+    }
     pure_literal_elimination(cnf, assignment);
 
     if (cnf.empty()) return true;
     for (const auto &clause : cnf) {
-        if (clause.empty()) return false;
+        if (clause.empty()) {
+            SAT_STAT(stats.conflicts++);
+            budget.conflict();
+            return false;
+        }
     }
 
     int var = 0;
-    for (const auto &clause : cnf) {
-        for (int lit : clause) {
-            var = abs(lit);
-            if (!assignment.count(var)) break;
+    {
+        SAT_PHASE_TIMER(stats.decide_ms);
+        for (const auto &clause : cnf) {
+            for (int lit : clause) {
+                var = abs(lit);
+                if (!assignment.count(var)) break;
+            }
+            if (var != 0) break;
         }
-        if (var != 0) break;
     }
 
+    SAT_STAT(stats.decisions++);
     Assignment copy = assignment;
     CNF cnf_copy = simplify(cnf, var, true);
     copy[var] = true;
-    if (dpll(cnf_copy, copy)) {
+    if (dpll(cnf_copy, copy, stats, budget)) {
         assignment = copy;
         return true;
     }
 
+    SAT_STAT(stats.decisions++);
     copy = assignment;
     cnf_copy = simplify(cnf, var, false);
     copy[var] = false;
-    if (dpll(cnf_copy, copy)) {
+    if (dpll(cnf_copy, copy, stats, budget)) {
         assignment = copy;
         return true;
     }
@@ -147,31 +144,38 @@ bool dpll(CNF cnf, Assignment &assignment) {
     return false;
 }
 
-int main() {
-    std::string folder = "../../cnf_files/samples/";
-    std::ofstream out("results_DPLL.txt");
-    out << std::fixed << std::setprecision(3);
-
-    for (const auto &entry : fs::directory_iterator(folder)) {
-        if (entry.path().extension() == ".cnf") {
-            std::string file = entry.path().string();
-            std::string name = entry.path().filename().string();
+int main(int argc, char *argv[]) {
+    BatchOptions batch;
+    batch.output_path = "results_DPLL.txt";
+    bool recursive = false;
+    bool arguments_ok = parse_batch_arguments(argc, argv, batch, [&](const std::string &arg) {
+        if (arg == "--engine=trail") recursive = false;
+        else if (arg == "--engine=recursive") recursive = true;
+        else return false;
+        return true;
+    });
+    if (!arguments_ok) return 1;
 
-            int num_vars;
-            CNF cnf = parse_cnf(file, num_vars);
+    return run_batch(batch, [&](const DimacsFormula &formula, const SolveContext &context, std::vector<bool> &model) {
+        CNF cnf = load_cnf(formula);
+        bool sat;
+        if (recursive) {
             Assignment assignment;
-
-            auto start = Clock::now();
-            bool sat = dpll(cnf, assignment);
-            auto end = Clock::now();
-
-            double ms = std::chrono::duration<double, std::milli>(end - start).count();
-            out << name << ": " << (sat ? "SAT" : "UNSAT") << " in " << ms << " ms\n";
-            std::cout << name << ": " << (sat ? "SAT" : "UNSAT") << " in " << ms << " ms\n";
+            sat = dpll(cnf, assignment, *context.statistics, *context.budget);
+            if (sat) {
+                model.assign(formula.variable_count + 1, false);
+                for (const auto &[var, value] : assignment) model[var] = value;
+            }
+        } else {
+            TrailDPLL solver(cnf, formula.variable_count);
+            solver.set_statistics(context.statistics);
+            solver.set_budget(context.budget);
+            sat = solver.solve();
+            if (sat) {
+                model.assign(formula.variable_count + 1, false);
+                for (int var = 1; var <= formula.variable_count; var++) model[var] = solver.model_value(var);
+            }
         }
-    }
-
-    out.close();
-    std::cout << "Results written to results.txt\n";
-    return 0;
-}
\ No newline at end of file
+        return std::string(sat ? "SAT" : "UNSAT");
+    });
+}
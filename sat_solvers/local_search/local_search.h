@@ -0,0 +1,383 @@
+#ifndef SAT_SOLVERS_LOCAL_SEARCH_LOCAL_SEARCH_H
+#define SAT_SOLVERS_LOCAL_SEARCH_LOCAL_SEARCH_H
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../common/budget.h"
+#include "../common/dimacs_parser.h"
+#include "../common/statistics.h"
+
+enum class LocalSearchMode { probsat, walksat, bit_parallel };
+
+struct LocalSearchOptions {
+    LocalSearchMode mode = LocalSearchMode::probsat;
+    // Total variable flips before giving up, over all lanes in bit-parallel mode.
+    long long max_flips = 10000000;
+    uint64_t seed = 1;
+    // probSAT picks a variable with probability proportional to
+    // (1 + break)^-cb; 2.38 is the published value for random 3-SAT.
+    double cb = 2.38;
+    // WalkSAT's chance of a random move when no flip is free.
+    double noise = 0.567;
+};
+
+enum class LocalSearchResult { satisfied, unsatisfied, gave_up };
+
+// Stochastic local search over complete assignments. Each step takes a
+// random unsatisfied clause and flips one of its variables: probSAT draws
+// it with a probability that falls with its break count, and WalkSAT takes
+// a flip that breaks nothing if there is one, otherwise a random variable
+// with probability noise and a least-breaking one (most making, then random
+// on ties) in the other cases. break[v] counts the clauses v alone
+// satisfies and make[v] the unsatisfied clauses containing v. Both are
+// updated on every flip from the true literal count of each touched clause
+// and the XOR of its true variables, which is the single true variable once
+// the count is 1. Unsatisfied clauses sit in a list with each one's
+// position, so they are added and removed in O(1).
+//
+// The search is incomplete: it finds models but cannot prove
+// unsatisfiability, and reports gave_up once the flips or the budget run
+// out. Only a formula with an empty clause is reported unsatisfied.
+class LocalSearch {
+private:
+    LocalSearchOptions options;
+    std::mt19937_64 generator;
+    int variable_count = 0;
+    std::vector<int> literals;
+    std::vector<size_t> clause_start;
+    std::vector<std::vector<int>> occurrences;
+    std::vector<char> value;
+    std::vector<int> true_count;
+    std::vector<int> true_xor;
+    std::vector<int> break_count;
+    std::vector<int> make_count;
+    std::vector<int> unsatisfied;
+    std::vector<int> unsatisfied_position;
+    std::vector<double> break_weight;
+    std::vector<double> weights;
+    bool empty_clause = false;
+    SolverStatistics own_statistics;
+    SolverStatistics *stats = &own_statistics;
+    SolveBudget *budget = nullptr;
+
+    static int index(int lit) { return 2 * std::abs(lit) + (lit < 0); }
+    bool is_true(int lit) const { return value[std::abs(lit)] == (lit > 0); }
+    size_t clause_count() const { return true_count.size(); }
+    void mark_unsatisfied(int c);
+    void mark_satisfied(int c);
+    void randomize();
+    void flip(int var);
+    int pick_probsat(int c);
+    int pick_walksat(int c);
+    template <int Width> LocalSearchResult solve_bit_parallel(const DimacsFormula &formula);
+
+public:
+    LocalSearch(const LocalSearchOptions &search_options = LocalSearchOptions())
+        : options(search_options), generator(search_options.seed) {}
+    void set_statistics(SolverStatistics *statistics) { stats = statistics; }
+    void set_budget(SolveBudget *solve_budget) { budget = solve_budget; }
+    LocalSearchResult solve(const DimacsFormula &formula);
+    // Fills model[v] for v in 1..variable_count after a satisfied result.
+    void model(std::vector<bool> &model) const;
+};
+
+inline void LocalSearch::mark_unsatisfied(int c) {
+    unsatisfied_position[c] = unsatisfied.size();
+    unsatisfied.push_back(c);
+}
+
+inline void LocalSearch::mark_satisfied(int c) {
+    int last = unsatisfied.back();
+    unsatisfied[unsatisfied_position[c]] = last;
+    unsatisfied_position[last] = unsatisfied_position[c];
+    unsatisfied.pop_back();
+}
+
+// Draws a fresh assignment and recomputes every counter from scratch.
+inline void LocalSearch::randomize() {
+    for (int var = 1; var <= variable_count; var++) value[var] = generator() & 1;
+    std::fill(break_count.begin(), break_count.end(), 0);
+    std::fill(make_count.begin(), make_count.end(), 0);
+    unsatisfied.clear();
+    for (size_t c = 0; c < clause_count(); c++) {
+        true_count[c] = 0;
+        true_xor[c] = 0;
+        for (size_t i = clause_start[c]; i < clause_start[c + 1]; i++) {
+            if (is_true(literals[i])) {
+                true_count[c]++;
+                true_xor[c] ^= std::abs(literals[i]);
+            }
+        }
+        if (true_count[c] == 0) {
+            mark_unsatisfied(c);
+            for (size_t i = clause_start[c]; i < clause_start[c + 1]; i++) make_count[std::abs(literals[i])]++;
+        } else if (true_count[c] == 1) {
+            break_count[true_xor[c]]++;
+        }
+    }
+}
+
+inline void LocalSearch::flip(int var) {
+    value[var] = !value[var];
+    int now_true = value[var] ? var : -var;
+    for (int c : occurrences[index(now_true)]) {
+        if (true_count[c] == 0) {
+            mark_satisfied(c);
+            for (size_t i = clause_start[c]; i < clause_start[c + 1]; i++) make_count[std::abs(literals[i])]--;
+            break_count[var]++;
+        } else if (true_count[c] == 1) {
+            break_count[true_xor[c]]--;
+        }
+        true_count[c]++;
+        true_xor[c] ^= var;
+    }
+    for (int c : occurrences[index(-now_true)]) {
+        true_count[c]--;
+        true_xor[c] ^= var;
+        if (true_count[c] == 0) {
+            mark_unsatisfied(c);
+            for (size_t i = clause_start[c]; i < clause_start[c + 1]; i++) make_count[std::abs(literals[i])]++;
+            break_count[var]--;
+        } else if (true_count[c] == 1) {
+            break_count[true_xor[c]]++;
+        }
+    }
+    SAT_STAT(stats->flips++);
+}
+
+inline int LocalSearch::pick_probsat(int c) {
+    double total = 0;
+    weights.clear();
+    for (size_t i = clause_start[c]; i < clause_start[c + 1]; i++) {
+        int breaks = break_count[std::abs(literals[i])];
+        total += breaks < (int)break_weight.size() ? break_weight[breaks] : 0;
+        weights.push_back(total);
+    }
+    double draw = std::uniform_real_distribution<double>(0, total)(generator);
+    size_t pick = std::upper_bound(weights.begin(), weights.end(), draw) - weights.begin();
+    return std::abs(literals[clause_start[c] + std::min(pick, weights.size() - 1)]);
+}
+
+inline int LocalSearch::pick_walksat(int c) {
+    size_t size = clause_start[c + 1] - clause_start[c];
+    int best = 0, best_break = 0, best_make = 0, ties = 0;
+    for (size_t i = clause_start[c]; i < clause_start[c + 1]; i++) {
+        int var = std::abs(literals[i]);
+        int breaks = break_count[var], makes = make_count[var];
+        if (best == 0 || breaks < best_break || (breaks == best_break && makes > best_make)) {
+            best = var;
+            best_break = breaks;
+            best_make = makes;
+            ties = 1;
+        } else if (breaks == best_break && makes == best_make && generator() % ++ties == 0) {
+            best = var;
+        }
+    }
+    if (best_break > 0 && std::uniform_real_distribution<double>(0, 1)(generator) < options.noise)
+        return std::abs(literals[clause_start[c] + generator() % size]);
+    return best;
+}
+
+inline LocalSearchResult LocalSearch::solve(const DimacsFormula &formula) {
+    variable_count = formula.variable_count;
+    literals.clear();
+    clause_start.assign(1, 0);
+    empty_clause = false;
+    int width = -1;
+    for (size_t c = 0; c < formula.clause_count(); c++) {
+        int size = formula.clause_end(c) - formula.clause_begin(c);
+        if (size == 0) empty_clause = true;
+        width = (width == -1 || width == size) ? size : 0;
+    }
+    if (empty_clause) return LocalSearchResult::unsatisfied;
+    value.assign(variable_count + 1, 0);
+    if (formula.clause_count() == 0) return LocalSearchResult::satisfied;
+
+    if (options.mode == LocalSearchMode::bit_parallel) {
+        switch (width) {
+            case 2: return solve_bit_parallel<2>(formula);
+            case 3: return solve_bit_parallel<3>(formula);
+            case 4: return solve_bit_parallel<4>(formula);
+            case 5: return solve_bit_parallel<5>(formula);
+            default: break;
+        }
+    }
+
+    // Duplicate literals would be counted twice and tautologies are always
+    // satisfied, so both are normalized away first.
+    std::vector<int> clause;
+    occurrences.assign(2 * variable_count + 2, std::vector<int>());
+    int max_occurrences = 0;
+    for (size_t c = 0; c < formula.clause_count(); c++) {
+        clause.assign(formula.clause_begin(c), formula.clause_end(c));
+        std::sort(clause.begin(), clause.end());
+        clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+        bool tautology = false;
+        for (int lit : clause)
+            if (lit > 0 && std::binary_search(clause.begin(), clause.end(), -lit)) tautology = true;
+        if (tautology) continue;
+        int kept = clause_start.size() - 1;
+        for (int lit : clause) {
+            literals.push_back(lit);
+            occurrences[index(lit)].push_back(kept);
+            max_occurrences = std::max<int>(max_occurrences, occurrences[index(lit)].size());
+        }
+        clause_start.push_back(literals.size());
+    }
+    size_t kept_clauses = clause_start.size() - 1;
+    true_count.assign(kept_clauses, 0);
+    true_xor.assign(kept_clauses, 0);
+    unsatisfied_position.assign(kept_clauses, 0);
+    break_count.assign(variable_count + 1, 0);
+    make_count.assign(variable_count + 1, 0);
+    break_weight.resize(max_occurrences + 1);
+    for (int breaks = 0; breaks <= max_occurrences; breaks++) {
+        break_weight[breaks] = std::pow(1.0 + breaks, -options.cb);
+    }
+    long long store_bytes = (long long)(2 * sizeof(int)) * literals.size() + 6 * sizeof(int) * kept_clauses;
+    if (budget != nullptr) budget->charge(store_bytes);
+
+    randomize();
+    SAT_STAT(stats->note_clause_count(kept_clauses));
+    for (long long flips = 0; flips < options.max_flips; flips++) {
+        if (unsatisfied.empty()) return LocalSearchResult::satisfied;
+        if (budget != nullptr && budget->exhausted()) break;
+        int c = unsatisfied[generator() % unsatisfied.size()];
+        flip(options.mode == LocalSearchMode::walksat ? pick_walksat(c) : pick_probsat(c));
+    }
+    return unsatisfied.empty() ? LocalSearchResult::satisfied : LocalSearchResult::gave_up;
+}
+
+// Runs 64 WalkSAT walks at once, one per bit of a word: bit k of
+// assignment[v] is the value of v in walk k. Clauses are swept in order. A
+// clause is evaluated for all walks with Width ORs, and every walk in which
+// it is false flips one of its variables, chosen by the WalkSAT rule above.
+// Break counts are bit-sliced: slice b of a counter holds bit b of the
+// count in each walk, counting saturates at 7, and flipping a false literal
+// l breaks a clause holding -l in exactly the walks where none of its other
+// literals is true. Minimums, noise and random picks are likewise done for
+// all walks with word operations. A walk that flipped nothing for a whole
+// sweep saw every clause satisfied, so its assignment is a model. Duplicate
+// literals and tautologies need no special care here.
+template <int Width>
+inline LocalSearchResult LocalSearch::solve_bit_parallel(const DimacsFormula &formula) {
+    const int slices = 3;
+    struct Counter {
+        uint64_t bit[slices] = {};
+    };
+    size_t clauses = formula.clause_count();
+    literals.assign(formula.literals.begin(), formula.literals.end());
+    occurrences.assign(2 * variable_count + 2, std::vector<int>());
+    for (size_t c = 0; c < clauses; c++)
+        for (int i = 0; i < Width; i++) occurrences[index(literals[c * Width + i])].push_back(c);
+    std::vector<uint64_t> assignment(variable_count + 1);
+    for (auto &word : assignment) word = generator();
+    if (budget != nullptr) budget->charge((long long)(2 * sizeof(int)) * literals.size() + 8 * assignment.size());
+    SAT_STAT(stats->note_clause_count(clauses));
+
+    auto lanes = [&](int lit) { return lit > 0 ? assignment[lit] : ~assignment[-lit]; };
+    auto add = [&](Counter &counter, uint64_t mask) {
+        for (int b = 0; b < slices; b++) {
+            uint64_t carry = counter.bit[b] & mask;
+            counter.bit[b] ^= mask;
+            mask = carry;
+        }
+        for (int b = 0; b < slices; b++) counter.bit[b] |= mask;
+    };
+    auto less = [&](const Counter &a, const Counter &b) {
+        uint64_t smaller = 0, equal = ~uint64_t(0);
+        for (int i = slices - 1; i >= 0; i--) {
+            smaller |= equal & ~a.bit[i] & b.bit[i];
+            equal &= ~(a.bit[i] ^ b.bit[i]);
+        }
+        return smaller;
+    };
+    // A mask whose bits are set with probability p, read from the 8 bits
+    // after the binary point, least significant first.
+    auto bernoulli = [&](double p) {
+        int fixed = (int)(p * 256);
+        uint64_t mask = 0;
+        for (int b = 0; b < 8; b++) mask = ((fixed >> b) & 1) ? (generator() | mask) : (generator() & mask);
+        return mask;
+    };
+    // Splits lanes into Width groups of equal probability, by rejection on
+    // ceil(log2 Width) random bits per lane.
+    const int bits = Width <= 2 ? 1 : Width <= 4 ? 2 : 3;
+    auto split_uniformly = [&](uint64_t pending, uint64_t *groups) {
+        while (pending != 0) {
+            uint64_t random[3];
+            for (int b = 0; b < bits; b++) random[b] = generator();
+            for (int i = 0; i < Width; i++) {
+                uint64_t match = pending;
+                for (int b = 0; b < bits; b++) match &= ((i >> b) & 1) ? random[b] : ~random[b];
+                groups[i] |= match;
+                pending &= ~match;
+            }
+        }
+    };
+
+    long long flips = 0;
+    while (flips < options.max_flips) {
+        uint64_t flipped_lanes = 0;
+        for (size_t c = 0; c < clauses; c++) {
+            size_t base = c * Width;
+            uint64_t satisfied = 0;
+            for (int i = 0; i < Width; i++) satisfied |= lanes(literals[base + i]);
+            uint64_t pending = ~satisfied;
+            if (pending == 0) continue;
+            flipped_lanes |= pending;
+
+            // best[i] marks the walks whose least-breaking variable so far is
+            // literal i, visiting the literals from a random start so ties
+            // are broken differently each time.
+            uint64_t best[Width] = {}, random_pick[Width] = {};
+            Counter minimum;
+            int start = generator() % Width;
+            for (int k = 0; k < Width; k++) {
+                int i = (start + k) % Width, held = -literals[base + i];
+                Counter breaks;
+                for (int d : occurrences[index(held)]) {
+                    uint64_t others = 0;
+                    for (int j = 0; j < Width; j++)
+                        if (literals[d * Width + j] != held) others |= lanes(literals[d * Width + j]);
+                    add(breaks, pending & ~others);
+                }
+                uint64_t better = (k == 0) ? ~uint64_t(0) : less(breaks, minimum);
+                for (int j = 0; j < Width; j++) best[j] &= ~better;
+                best[i] = better;
+                for (int b = 0; b < slices; b++)
+                    minimum.bit[b] = (better & breaks.bit[b]) | (~better & minimum.bit[b]);
+            }
+            uint64_t breaks_something = minimum.bit[0] | minimum.bit[1] | minimum.bit[2];
+            uint64_t noisy = pending & breaks_something & bernoulli(options.noise);
+            split_uniformly(noisy, random_pick);
+            for (int i = 0; i < Width; i++) {
+                uint64_t chosen = (pending & ~noisy & best[i]) | random_pick[i];
+                assignment[std::abs(literals[base + i])] ^= chosen;
+                flips += std::bitset<64>(chosen).count();
+                SAT_STAT(stats->flips += std::bitset<64>(chosen).count());
+            }
+            if (budget != nullptr && budget->exhausted()) return LocalSearchResult::gave_up;
+        }
+        if (flipped_lanes != ~uint64_t(0)) {
+            int lane = 0;
+            while ((flipped_lanes >> lane) & 1) lane++;
+            for (int var = 1; var <= variable_count; var++) value[var] = (assignment[var] >> lane) & 1;
+            return LocalSearchResult::satisfied;
+        }
+    }
+    return LocalSearchResult::gave_up;
+}
+
+inline void LocalSearch::model(std::vector<bool> &model) const {
+    model.assign(variable_count + 1, false);
+    for (int var = 1; var <= variable_count; var++) model[var] = value[var];
+}
+
+#endif
@@ -0,0 +1,46 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../common/batch_driver.h"
+#include "../common/dimacs_parser.h"
+#include "local_search.h"
+
+int main(int argc, char *argv[]) {
+    LocalSearchOptions options;
+    BatchOptions batch;
+    batch.output_path = "results_local_search.txt";
+    bool arguments_ok = parse_batch_arguments(argc, argv, batch, [&](const std::string &arg) {
+        if (arg == "--mode=probsat") {
+            options.mode = LocalSearchMode::probsat;
+        } else if (arg == "--mode=walksat") {
+            options.mode = LocalSearchMode::walksat;
+        } else if (arg == "--mode=bit-parallel") {
+            options.mode = LocalSearchMode::bit_parallel;
+        } else if (arg.rfind("--max-flips=", 0) == 0) {
+            options.max_flips = std::stoll(arg.substr(12));
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            options.seed = std::stoull(arg.substr(7));
+        } else if (arg.rfind("--cb=", 0) == 0) {
+            options.cb = std::stod(arg.substr(5));
+        } else if (arg.rfind("--noise=", 0) == 0) {
+            options.noise = std::stod(arg.substr(8));
+        } else {
+            return false;
+        }
+        return true;
+    });
+    if (!arguments_ok) return 1;
+
+    return run_batch(batch, [&](const DimacsFormula &formula, const SolveContext &context, std::vector<bool> &model) {
+        LocalSearch search(options);
+        search.set_statistics(context.statistics);
+        search.set_budget(context.budget);
+        LocalSearchResult result = search.solve(formula);
+        if (result == LocalSearchResult::satisfied) {
+            search.model(model);
+            return std::string("SAT");
+        }
+        return std::string(result == LocalSearchResult::unsatisfied ? "UNSAT" : "UNKNOWN");
+    });
+}
@@ -0,0 +1,178 @@
+#ifndef SAT_SOLVERS_PORTFOLIO_PORTFOLIO_H
+#define SAT_SOLVERS_PORTFOLIO_PORTFOLIO_H
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../cdcl/cdcl_solver.h"
+#include "../common/budget.h"
+#include "../common/dimacs_parser.h"
+#include "../common/drat_writer.h"
+#include "../common/statistics.h"
+#include "../dpll/dpll_solver.h"
+#include "../local_search/local_search.h"
+
+enum class PortfolioEngine { cdcl, dpll, local_search };
+
+// One entry of a portfolio: an engine and the options it runs with.
+struct PortfolioConfiguration {
+    std::string name;
+    PortfolioEngine engine = PortfolioEngine::cdcl;
+    CDCLOptions cdcl;
+    LocalSearchOptions local_search;
+};
+
+// The first size configurations of the default portfolio. It starts with
+// the most diverse ones: default CDCL, probSAT, DPLL, then CDCL with other
+// restarts, phases and branching and WalkSAT. Past the fixed list, CDCL
+// runs again with new seeds, alternating glucose and Luby restarts.
+inline std::vector<PortfolioConfiguration> default_portfolio(int size) {
+    std::vector<PortfolioConfiguration> portfolio;
+    auto add_cdcl = [&](const std::string &name, uint32_t seed, RestartPolicy restarts) {
+        PortfolioConfiguration configuration;
+        configuration.name = name;
+        configuration.cdcl.seed = seed;
+        configuration.cdcl.restart_policy = restarts;
+        portfolio.push_back(configuration);
+        return &portfolio.back();
+    };
+    auto add_local_search = [&](const std::string &name, LocalSearchMode mode, uint64_t seed) {
+        PortfolioConfiguration configuration;
+        configuration.name = name;
+        configuration.engine = PortfolioEngine::local_search;
+        configuration.local_search.mode = mode;
+        configuration.local_search.seed = seed;
+        // The race, not the flip count, decides when it stops.
+        configuration.local_search.max_flips = std::numeric_limits<long long>::max();
+        portfolio.push_back(configuration);
+    };
+
+    add_cdcl("cdcl", 1, RestartPolicy::rs_glucose);
+    add_local_search("probsat", LocalSearchMode::probsat, 1);
+    PortfolioConfiguration dpll;
+    dpll.name = "dpll";
+    dpll.engine = PortfolioEngine::dpll;
+    portfolio.push_back(dpll);
+    add_cdcl("cdcl-luby", 2, RestartPolicy::rs_luby);
+    add_cdcl("cdcl-static-phase", 3, RestartPolicy::rs_glucose)->cdcl.phase_saving = false;
+    add_local_search("walksat", LocalSearchMode::walksat, 2);
+    add_cdcl("cdcl-frequency", 4, RestartPolicy::rs_glucose)->cdcl.branching_heuristic =
+        BranchingHeuristic::b_frequency;
+    add_cdcl("cdcl-glue3", 5, RestartPolicy::rs_glucose)->cdcl.glue_lbd = 3;
+    for (int i = portfolio.size(); i < size; i++) {
+        bool luby = i % 2 == 1;
+        add_cdcl(std::string(luby ? "cdcl-luby-seed" : "cdcl-seed") + std::to_string(i + 1), i + 1,
+                 luby ? RestartPolicy::rs_luby : RestartPolicy::rs_glucose);
+    }
+    if ((size_t)size < portfolio.size()) portfolio.resize(std::max(size, 1));
+    return portfolio;
+}
+
+struct PortfolioResult {
+    // "SAT" or "UNSAT" once a configuration has answered, otherwise the
+    // budget outcome of the race, e.g. "TIMEOUT".
+    std::string outcome;
+    // Index of the configuration that answered, or -1.
+    int winner = -1;
+    std::vector<bool> model;
+    // The statistics of the winner, or of the first configuration.
+    SolverStatistics statistics;
+};
+
+// Runs every configuration on its own thread and takes the first answer.
+// Each gets a copy of budget, so the limits apply to every configuration
+// on its own, and all copies share one stop flag. The winner raises it, and
+// the others notice at their next budget check and return. Local search can
+// only answer SAT. A proof, if given, is logged by the first CDCL
+// configuration alone, and an UNSAT answer then only counts from it, so
+// the proof always matches the answer.
+inline PortfolioResult race_portfolio(const DimacsFormula &formula,
+                                      const std::vector<PortfolioConfiguration> &configurations,
+                                      const SolveBudget &budget, DratWriter *proof = nullptr) {
+    struct Racer {
+        SolveBudget budget;
+        SolverStatistics statistics;
+    };
+    std::vector<Racer> racers(configurations.size());
+    std::atomic<bool> stop(false);
+    std::mutex result_lock;
+    PortfolioResult result;
+    int proof_racer = -1;
+    for (size_t i = 0; i < configurations.size() && proof != nullptr && proof_racer < 0; i++)
+        if (configurations[i].engine == PortfolioEngine::cdcl) proof_racer = i;
+
+    auto race = [&](int i) {
+        const PortfolioConfiguration &configuration = configurations[i];
+        Racer &racer = racers[i];
+        racer.budget = budget;
+        racer.budget.set_stop_flag(&stop);
+        bool answered = false, sat = false;
+        std::vector<bool> model;
+        if (configuration.engine == PortfolioEngine::cdcl) {
+            SATSolverCDCL solver(configuration.cdcl);
+            if (i == proof_racer) solver.set_proof(proof);
+            solver.set_statistics(&racer.statistics);
+            solver.set_budget(&racer.budget);
+            solver.initialize(formula);
+            int outcome = solver.solve();
+            answered = outcome != RetVal::r_unknown;
+            sat = outcome == RetVal::r_satisfied;
+            if (sat) solver.model(model);
+        } else if (configuration.engine == PortfolioEngine::dpll) {
+            TrailDPLL solver(load_cnf(formula), formula.variable_count);
+            solver.set_statistics(&racer.statistics);
+            solver.set_budget(&racer.budget);
+            sat = solver.solve();
+            answered = true;
+            if (sat) {
+                model.assign(formula.variable_count + 1, false);
+                for (int var = 1; var <= formula.variable_count; var++) model[var] = solver.model_value(var);
+            }
+        } else {
+            LocalSearch search(configuration.local_search);
+            search.set_statistics(&racer.statistics);
+            search.set_budget(&racer.budget);
+            LocalSearchResult outcome = search.solve(formula);
+            answered = outcome != LocalSearchResult::gave_up;
+            sat = outcome == LocalSearchResult::satisfied;
+            if (sat) search.model(model);
+        }
+        // A run stopped by its budget may return anything.
+        if (racer.budget.state() != SolveBudget::within_budget) answered = false;
+        if (!sat && proof_racer >= 0 && i != proof_racer) answered = false;
+        if (!answered) return;
+        std::lock_guard<std::mutex> guard(result_lock);
+        if (result.winner >= 0) return;
+        result.winner = i;
+        result.outcome = sat ? "SAT" : "UNSAT";
+        result.model.swap(model);
+        stop.store(true, std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < configurations.size(); i++) threads.emplace_back(race, (int)i);
+    if (!configurations.empty()) race(0);
+    for (auto &thread : threads) thread.join();
+
+    if (result.winner >= 0) {
+        result.statistics = racers[result.winner].statistics;
+        return result;
+    }
+    // Nobody answered. Time or memory running out anywhere is reported as
+    // such; otherwise every configuration gave up, which is UNKNOWN.
+    bool out_of_time = false, out_of_memory = false;
+    for (const auto &racer : racers) {
+        out_of_time |= racer.budget.state() == SolveBudget::out_of_time;
+        out_of_memory |= racer.budget.state() == SolveBudget::out_of_memory;
+    }
+    result.outcome = out_of_time ? "TIMEOUT" : out_of_memory ? "MEMOUT" : "UNKNOWN";
+    if (!racers.empty()) result.statistics = racers[0].statistics;
+    return result;
+}
+
+#endif
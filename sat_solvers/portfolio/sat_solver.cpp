@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/batch_driver.h"
+#include "../common/dimacs_parser.h"
+#include "portfolio.h"
+
+int main(int argc, char *argv[]) {
+    BatchOptions batch;
+    batch.output_path = "results_portfolio.txt";
+    int racers = std::max(2, std::min(8, (int)std::thread::hardware_concurrency()));
+    bool verbose = false;
+    bool arguments_ok = parse_batch_arguments(argc, argv, batch, [&](const std::string &arg) {
+        if (arg.rfind("--racers=", 0) == 0) {
+            racers = std::max(1, std::stoi(arg.substr(9)));
+        } else if (arg == "--verbose") {
+            verbose = true;
+        } else {
+            return false;
+        }
+        return true;
+    });
+    if (!arguments_ok) return 1;
+    batch.solver_threads = racers;
+
+    std::vector<PortfolioConfiguration> portfolio = default_portfolio(racers);
+    std::mutex log_lock;
+    return run_batch(batch, [&](const DimacsFormula &formula, const SolveContext &context, std::vector<bool> &model) {
+        DratWriter proof;
+        bool logging = false;
+        if (!context.proof_path.empty()) {
+            logging = proof.open(context.proof_path);
+            if (!logging) std::cerr << "Error: cannot write " << context.proof_path << "\n";
+        }
+        PortfolioResult result = race_portfolio(formula, portfolio, *context.budget, logging ? &proof : nullptr);
+        double preprocess_ms = context.statistics->preprocess_ms;
+        *context.statistics = result.statistics;
+        context.statistics->preprocess_ms = preprocess_ms;
+        if (verbose) {
+            std::lock_guard<std::mutex> guard(log_lock);
+            std::cerr << context.name << ": " << result.outcome << " by "
+                      << (result.winner >= 0 ? portfolio[result.winner].name : std::string("none")) << "\n";
+        }
+        model.swap(result.model);
+        return result.outcome;
+    });
+}
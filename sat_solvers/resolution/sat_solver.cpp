@@ -1,104 +1,211 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
 #include <set>
 #include <unordered_set>
-#include <chrono>
-#include <filesystem>
-#include <iomanip>
+#include <queue>
+#include <cstdint>
+#include <algorithm>
+
+#include "../common/batch_driver.h"
+#include "../common/dimacs_parser.h"
 
-namespace fs = std::filesystem;
 using namespace std;
 
 using Clause = set<int>;
 using CNF = vector<Clause>;
 
-CNF parse_cnf(const string &filename) {
-    ifstream file(filename);
-    string line;
+CNF load_cnf(const DimacsFormula &dimacs) {
     CNF formula;
+    formula.reserve(dimacs.clause_count());
+    for (size_t i = 0; i < dimacs.clause_count(); i++)
+        formula.emplace_back(dimacs.clause_begin(i), dimacs.clause_end(i));
+    return formula;
+}
+
+// Resolution by given-clause saturation. Clauses are sorted literal vectors
+// kept in one store, and a hash set of their contents stops the same clause
+// from being stored twice. Every live clause is listed in the occurrence
+// lists of its literals. Removed clauses stay in the lists until the next
+// lookup of that list drops them.
+//
+// Clauses wait in a queue, shortest first. The loop takes the next one as
+// the given clause and resolves it against every processed clause holding
+// a complementary literal, then marks it processed. Each pair is therefore
+// resolved once. Tautologies are dropped, resolvents subsumed by a live
+// clause are discarded, and live clauses a resolvent subsumes are removed.
+// The formula is unsatisfiable once the empty clause is derived and
+// satisfiable once the queue runs dry.
+class ResolutionProver {
+private:
+    struct ClauseHash {
+        size_t operator()(const vector<int> &clause) const {
+            uint64_t hash = 14695981039346656037ull;
+            for (int lit : clause) hash = (hash ^ (uint32_t)lit) * 1099511628211ull;
+            return hash;
+        }
+    };
+
+    vector<vector<int>> clauses;
+    vector<char> removed;
+    vector<char> processed;
+    vector<uint64_t> signatures;
+    vector<vector<int>> occurrences;
+    unordered_set<vector<int>, ClauseHash> seen;
+    // (size, clause) pairs, so short clauses are given first.
+    priority_queue<pair<size_t, int>, vector<pair<size_t, int>>, greater<pair<size_t, int>>> unprocessed;
+    bool empty_clause_found;
+    SolverStatistics *stats;
+    SolveBudget *budget;
+
+    static int occurrence_index(int lit) { return 2 * abs(lit) + (lit < 0); }
+    static uint64_t signature(const vector<int> &clause);
+    const vector<int> &live_occurrences(int lit);
+    bool subsumed_by_existing(const vector<int> &clause, uint64_t clause_signature);
+    void remove_subsumed(const vector<int> &clause, uint64_t clause_signature);
+    void add_clause(const vector<int> &clause);
+    static bool resolve(const vector<int> &c1, const vector<int> &c2, int lit, vector<int> &resolvent);
 
-    while (getline(file, line)) {
-        if (line.empty() || line[0] == 'c') continue;
-        if (line[0] == 'p') continue;
+public:
+    ResolutionProver(const CNF &cnf, int num_vars, SolverStatistics *statistics, SolveBudget *solve_budget);
+    bool solve();
+};
 
-        istringstream iss(line);
-        int lit;
-        Clause clause;
-        while (iss >> lit && lit != 0) clause.insert(lit);
-        formula.push_back(clause);
+ResolutionProver::ResolutionProver(const CNF &cnf, int num_vars, SolverStatistics *statistics,
+                                   SolveBudget *solve_budget)
+    : occurrences(2 * num_vars + 2), empty_clause_found(false), stats(statistics), budget(solve_budget) {
+    for (const auto &clause : cnf) {
+        bool tautology = false;
+        for (int lit : clause)
+            if (lit > 0 && clause.count(-lit)) tautology = true;
+        if (!tautology) add_clause(vector<int>(clause.begin(), clause.end()));
     }
-    return formula;
 }
 
-bool resolve(const Clause &c1, const Clause &c2, Clause &resolvent) {
-    for (int lit : c1) {
-        if (c2.count(-lit)) {
-            resolvent.clear();
-            for (int l : c1) if (l != lit) resolvent.insert(l);
-            for (int l : c2) if (l != -lit) resolvent.insert(l);
-            return true;
+// One bit per variable modulo 64. If a clause subsumes another, its bits are
+// a subset of the other's, which rules out most candidate pairs cheaply.
+uint64_t ResolutionProver::signature(const vector<int> &clause) {
+    uint64_t bits = 0;
+    for (int lit : clause) bits |= uint64_t(1) << (abs(lit) & 63);
+    return bits;
+}
+
+const vector<int> &ResolutionProver::live_occurrences(int lit) {
+    vector<int> &list = occurrences[occurrence_index(lit)];
+    list.erase(remove_if(list.begin(), list.end(), [this](int c) { return removed[c]; }), list.end());
+    return list;
+}
+
+// Forward subsumption: a clause subsuming the new one contains one of its
+// literals, so only those occurrence lists need checking.
+bool ResolutionProver::subsumed_by_existing(const vector<int> &clause, uint64_t clause_signature) {
+    for (int lit : clause) {
+        for (int c : live_occurrences(lit)) {
+            if ((signatures[c] & ~clause_signature) != 0 || clauses[c].size() > clause.size()) continue;
+            if (includes(clause.begin(), clause.end(), clauses[c].begin(), clauses[c].end())) return true;
         }
     }
     return false;
 }
 
-bool resolution_algorithm(CNF formula) {
-    set<Clause> clauses(formula.begin(), formula.end());
-    bool added = true;
-
-    while (added) {
-        added = false;
-        vector<Clause> new_clauses;
-        for (auto it1 = clauses.begin(); it1 != clauses.end(); ++it1) {
-            for (auto it2 = next(it1); it2 != clauses.end(); ++it2) {
-                Clause resolvent;
-                if (resolve(*it1, *it2, resolvent)) {
-                    if (resolvent.empty()) return false;
-                    if (!clauses.count(resolvent)) {
-                        new_clauses.push_back(resolvent);
-                    }
-                }
-            }
-        }
-        for (auto &c : new_clauses) {
-            clauses.insert(c);
-            added = true;
+// Backward subsumption: every clause the new one subsumes contains all of
+// its literals, so the shortest occurrence list among them holds them all.
+void ResolutionProver::remove_subsumed(const vector<int> &clause, uint64_t clause_signature) {
+    int best = clause[0];
+    for (int lit : clause)
+        if (live_occurrences(lit).size() < live_occurrences(best).size()) best = lit;
+    for (int c : live_occurrences(best)) {
+        if ((clause_signature & ~signatures[c]) != 0 || clauses[c].size() < clause.size()) continue;
+        if (includes(clauses[c].begin(), clauses[c].end(), clause.begin(), clause.end())) {
+            budget->release(sizeof(int) * clauses[c].size());
+            removed[c] = 1;
+            vector<int>().swap(clauses[c]);
         }
     }
-    return true;
 }
 
-int main() {
-    string folder = "../../cnf_files/samples/";
-    ofstream out("results_resolution.txt");
-    out << fixed << setprecision(3);
-
-    if (!fs::exists(folder) || !fs::is_directory(folder)) {
-        cerr << "Error: directory not found: " << folder << "\n";
-        return 1;
+// Queues a sorted, duplicate free, non tautological clause unless it was
+// seen before or a live clause already subsumes it.
+void ResolutionProver::add_clause(const vector<int> &clause) {
+    if (clause.empty()) {
+        empty_clause_found = true;
+        return;
     }
+    if (!seen.insert(clause).second) return;
+    uint64_t clause_signature = signature(clause);
+    if (subsumed_by_existing(clause, clause_signature)) return;
+    remove_subsumed(clause, clause_signature);
 
-    for (const auto &entry : fs::directory_iterator(folder)) {
-        if (entry.path().extension() == ".cnf") {
-            string file = entry.path().string();
-            string name = entry.path().filename().string();
-
-            CNF cnf = parse_cnf(file);
+    // The clause is stored, kept in the seen set and listed once per literal.
+    budget->charge(2 * sizeof(vector<int>) + 3 * sizeof(int) * clause.size() + sizeof(uint64_t) + 2 * sizeof(char));
+    int c = clauses.size();
+    clauses.push_back(clause);
+    removed.push_back(0);
+    processed.push_back(0);
+    signatures.push_back(clause_signature);
+    for (int lit : clause) occurrences[occurrence_index(lit)].push_back(c);
+    unprocessed.push({clause.size(), c});
+    SAT_STAT(stats->note_clause_count(clauses.size()));
+}
 
-            auto start = chrono::high_resolution_clock::now();
-            bool sat = resolution_algorithm(cnf);
-            auto end = chrono::high_resolution_clock::now();
+// Merges two sorted clauses without lit and -lit, where lit is in c1 and
+// -lit in c2. Returns false for a tautological resolvent, which is dropped.
+bool ResolutionProver::resolve(const vector<int> &c1, const vector<int> &c2, int lit, vector<int> &resolvent) {
+    resolvent.clear();
+    size_t i = 0, j = 0;
+    while (i < c1.size() || j < c2.size()) {
+        int next;
+        if (j == c2.size() || (i < c1.size() && c1[i] < c2[j])) next = c1[i++];
+        else if (i == c1.size() || c2[j] < c1[i]) next = c2[j++];
+        else { next = c1[i++]; j++; }
+        if (next == lit || next == -lit) continue;
+        if (binary_search(c1.begin(), c1.end(), -next) || binary_search(c2.begin(), c2.end(), -next)) return false;
+        resolvent.push_back(next);
+    }
+    return true;
+}
 
-            double ms = chrono::duration<double, milli>(end - start).count();
-            out << name << ": " << (sat ? "SAT" : "UNSAT") << " in " << ms << " ms\n";
-            cout << name << ": " << (sat ? "SAT" : "UNSAT") << " in " << ms << " ms\n";
+bool ResolutionProver::solve() {
+    SAT_PHASE_TIMER(stats->resolve_ms);
+    vector<int> resolvent, partners;
+    while (!empty_clause_found && !unprocessed.empty()) {
+        int given = unprocessed.top().second;
+        unprocessed.pop();
+        if (removed[given]) continue;
+        if (budget->exhausted()) return false;
+        processed[given] = 1;
+        // Resolvents can remove the given clause, so work on a copy.
+        vector<int> given_clause = clauses[given];
+        for (int lit : given_clause) {
+            partners = live_occurrences(-lit);
+            for (int c : partners) {
+                if (removed[c] || !processed[c]) continue;
+                if (resolve(given_clause, clauses[c], lit, resolvent)) {
+                    SAT_STAT(stats->resolvents++);
+                    add_clause(resolvent);
+                }
+                if (empty_clause_found || budget->exhausted()) return false;
+            }
         }
     }
+    return !empty_clause_found;
+}
+
+// Returns false without a full search once the budget is exhausted, which
+// the caller tells apart through the budget.
+bool resolution_algorithm(const CNF &formula, int num_vars, SolverStatistics &stats, SolveBudget &budget) {
+    ResolutionProver prover(formula, num_vars, &stats, &budget);
+    return prover.solve();
+}
+
+int main(int argc, char *argv[]) {
+    BatchOptions batch;
+    batch.output_path = "results_resolution.txt";
+    if (!parse_batch_arguments(argc, argv, batch)) return 1;
 
-    out.close();
-    cout << "Results written to results_resolution.txt\n";
-    return 0;
+    return run_batch(batch, [](const DimacsFormula &formula, const SolveContext &context, std::vector<bool> &) {
+        CNF cnf = load_cnf(formula);
+        bool sat = resolution_algorithm(cnf, formula.variable_count, *context.statistics, *context.budget);
+        return string(sat ? "SAT" : "UNSAT");
+    });
 }
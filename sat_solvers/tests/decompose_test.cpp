@@ -0,0 +1,117 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../cdcl/parallel_cdcl.h"
+#include "../common/batch_driver.h"
+#include "../common/dimacs_parser.h"
+#include "../cube_and_conquer/cube_and_conquer.h"
+#include "../portfolio/portfolio.h"
+
+// Checks that an UNSAT component stops the other components of a formula
+// under --decompose=on, also when they are solved by an engine that races
+// threads of its own. The formula joins a pigeonhole formula, which takes
+// CDCL far longer than the time limit, and a contradiction on a separate
+// variable. The contradiction is only refuted once the pigeonhole search
+// is under way, and the run has to answer UNSAT well before the limit.
+
+static const double time_limit = 30;
+static const double max_seconds = 5;
+
+static void add_clause(DimacsFormula &formula, const std::vector<int> &clause) {
+    formula.literals.insert(formula.literals.end(), clause.begin(), clause.end());
+    formula.clause_offsets.push_back(formula.literals.size());
+}
+
+// holes + 1 pigeons in holes holes, plus x and not x for a fresh variable x.
+static DimacsFormula pigeonhole_and_contradiction(int holes) {
+    DimacsFormula formula;
+    int pigeons = holes + 1;
+    auto var = [&](int pigeon, int hole) { return pigeon * holes + hole + 1; };
+    for (int pigeon = 0; pigeon < pigeons; pigeon++) {
+        std::vector<int> clause;
+        for (int hole = 0; hole < holes; hole++) clause.push_back(var(pigeon, hole));
+        add_clause(formula, clause);
+    }
+    for (int hole = 0; hole < holes; hole++)
+        for (int first = 0; first < pigeons; first++)
+            for (int second = first + 1; second < pigeons; second++)
+                add_clause(formula, {-var(first, hole), -var(second, hole)});
+    int x = pigeons * holes + 1;
+    add_clause(formula, {x});
+    add_clause(formula, {-x});
+    formula.variable_count = x;
+    formula.declared_clause_count = formula.clause_count();
+    return formula;
+}
+
+static bool run_case(const std::string &name, const SolveFunction &engine) {
+    DimacsFormula formula = pigeonhole_and_contradiction(10);
+    SolveFunction solve = [&](const DimacsFormula &component, const SolveContext &context, std::vector<bool> &model) {
+        if (component.variable_count == 1) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        return engine(component, context, model);
+    };
+    BatchOptions options;
+    options.decompose = true;
+    options.two_sat_dispatch = false;
+    options.component_threads = 2;
+    options.solver_threads = 2;
+    BudgetLimits limits;
+    limits.seconds = time_limit;
+    SolveBudget budget(limits);
+    SolverStatistics statistics;
+    SolveContext context;
+    context.name = name;
+    context.statistics = &statistics;
+    context.budget = &budget;
+    std::vector<bool> model;
+
+    auto start = std::chrono::steady_clock::now();
+    std::string outcome = solve_components(options, solve, formula, context, model);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bool ok = outcome == "UNSAT" && seconds < max_seconds;
+    std::cout << (ok ? "ok   " : "FAIL ") << name << ": " << outcome << " in " << seconds << " s\n";
+    return ok;
+}
+
+// A copy of a budget that gets a stop flag of its own still stops with the
+// flag of the budget it was copied from.
+static bool nested_stop_flags() {
+    std::atomic<bool> outer(false), inner(false);
+    SolveBudget budget;
+    budget.set_stop_flag(&outer);
+    SolveBudget copy = budget;
+    copy.set_stop_flag(&inner);
+    bool ok = !copy.exhausted();
+    outer.store(true);
+    ok = ok && copy.exhausted() && copy.state() == SolveBudget::cancelled;
+    std::cout << (ok ? "ok   " : "FAIL ") << "nested stop flags\n";
+    return ok;
+}
+
+int main() {
+    bool ok = nested_stop_flags();
+    ok &= run_case("parallel cdcl", [](const DimacsFormula &formula, const SolveContext &context,
+                                       std::vector<bool> &model) {
+        ParallelCDCLResult result = solve_parallel_cdcl(formula, CDCLOptions(), 2, *context.budget);
+        model.swap(result.model);
+        return result.outcome;
+    });
+    ok &= run_case("portfolio", [](const DimacsFormula &formula, const SolveContext &context,
+                                   std::vector<bool> &model) {
+        PortfolioResult result = race_portfolio(formula, default_portfolio(2), *context.budget);
+        model.swap(result.model);
+        return result.outcome;
+    });
+    ok &= run_case("cube and conquer", [](const DimacsFormula &formula, const SolveContext &context,
+                                          std::vector<bool> &model) {
+        CubeOptions options;
+        options.workers = 2;
+        CubeAndConquerResult result = cube_and_conquer(formula, options, *context.budget);
+        model.swap(result.model);
+        return result.outcome;
+    });
+    return ok ? 0 : 1;
+}